@@ -89,11 +89,34 @@ config_string(KernelMaxNumWorkUnitsPerPreemption MAX_NUM_WORK_UNITS_PER_PREEMPTI
     DEFAULT 100
     UNQUOTE
 )
+config_option(KernelRevokeBatch REVOKE_BATCH
+    "Let revoke delete capabilities that need no finalisation, such as copies of\
+    capabilities that are not the last reference to their object, by emptying their\
+    slot directly, and count a batch of them as a single work unit."
+    DEFAULT OFF
+    DEPENDS "NOT KernelVerificationBuild"
+)
+config_string(KernelRevokeBatchSize REVOKE_BATCH_SIZE
+    "Number of capabilities that need no finalisation that revoke deletes as a single\
+    work unit."
+    DEFAULT 8
+    DEPENDS "KernelRevokeBatch" UNDEF_DISABLED
+    UNQUOTE
+)
 config_string(KernelResetChunkBits RESET_CHUNK_BITS
     "Maximum size in bits of chunks of memory to zero before checking a preemption point."
     DEFAULT 8
     UNQUOTE
 )
+config_option(KernelUntypedReclaimLast UNTYPED_RECLAIM_LAST
+    "When the last capability to an endpoint or notification is deleted, and it was the \
+    most recent allocation from its untyped, return its memory to the untyped so that \
+    it can be retyped again without resetting the whole untyped. Only the allocation at \
+    the free index is reclaimed. Memory freed in any other order is not tracked and is \
+    reused only after the untyped is reset."
+    DEFAULT OFF
+    DEPENDS "NOT KernelVerificationBuild"
+)
 config_string(KernelMaxNumBootinfoUntypedCaps MAX_NUM_BOOTINFO_UNTYPED_CAPS
     "Max number of bootinfo untyped caps"
     DEFAULT 230
@@ -101,6 +124,59 @@ config_string(KernelMaxNumBootinfoUntypedCaps MAX_NUM_BOOTINFO_UNTYPED_CAPS
 )
 config_option(KernelFastpath FASTPATH "Enable IPC fastpath" DEFAULT ON)
 
+config_option(KernelFastpathVMFault FASTPATH_VM_FAULT
+    "Deliver VM faults to the fault handler on a fastpath. This applies when the fault \
+    handler is waiting on its endpoint, runs on the same core and in the same domain, \
+    and can be switched to directly. All other faults are delivered by the slowpath."
+    DEFAULT OFF
+    DEPENDS "KernelFastpath;NOT KernelVerificationBuild"
+)
+
+config_option(KernelFastpathExceptionIPC FASTPATH_EXCEPTION_IPC
+    "Deliver unknown syscall and user exception faults to the fault handler, and replies \
+    to them from ReplyRecv, on a fastpath. Only the registers selected by \
+    KernelFastpathSyscallMessageMask and KernelFastpathExceptionMessageMask are \
+    transferred in either direction."
+    DEFAULT OFF
+    DEPENDS "KernelFastpath;NOT KernelVerificationBuild"
+)
+
+config_string(KernelFastpathSyscallMessageMask FASTPATH_SYSCALL_MESSAGE_MASK
+    "Bitmask of the registers of an unknown syscall fault message, by their index in the \
+    message, that the exception IPC fastpath transfers. Message registers that are not \
+    selected are left undefined when the fault is sent and are ignored in the reply."
+    DEFAULT 0xffffffff
+    DEPENDS "KernelFastpathExceptionIPC" UNDEF_DISABLED
+    UNQUOTE
+)
+
+config_string(KernelFastpathExceptionMessageMask FASTPATH_EXCEPTION_MESSAGE_MASK
+    "Bitmask of the registers of a user exception fault message, by their index in the \
+    message, that the exception IPC fastpath transfers. Message registers that are not \
+    selected are left undefined when the fault is sent and are ignored in the reply."
+    DEFAULT 0xffffffff
+    DEPENDS "KernelFastpathExceptionIPC" UNDEF_DISABLED
+    UNQUOTE
+)
+
+config_option(KernelInfoPage KERNEL_INFO_PAGE
+    "Export a read-only page with the current domain, the remaining domain time, the number \
+    of runnable threads and idle time counters of each core, and the frequency of the \
+    timestamp counter. The initial thread receives a frame cap to it, which can be mapped \
+    into any VSpace that wants to read the information without entering the kernel."
+    DEFAULT OFF
+    DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
+)
+
+config_option(KernelThreadCPUTime THREAD_CPU_TIME
+    "Account the CPU time of every thread in timestamp counter cycles. The count of a thread \
+    is updated whenever the kernel switches away from it and can be read with \
+    seL4_TCB_GetCPUTime. Unlike the utilisation tracking of benchmark builds this is always \
+    active and does not need to be enabled at run time."
+    DEFAULT OFF
+    DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
+)
+
 config_string(KernelNumDomains NUM_DOMAINS "The number of scheduler domains in the system" DEFAULT 1 UNQUOTE)
 
 find_file(KernelDomainSchedule default_domain.c PATHS src/config CMAKE_FIND_ROOT_PATH_BOTH
@@ -139,6 +215,25 @@ config_string(KernelFPUMaxRestoresSinceSwitch FPU_MAX_RESTORES_SINCE_SWITCH
     UNQUOTE
 )
 
+config_option(KernelFPUEager FPU_EAGER
+    "Track the FPU usage of each thread and restore the FPU state of threads that use it\
+    in consecutive time slices eagerly whenever they are switched to, instead of waiting\
+    for them to take an FPU fault."
+    DEFAULT OFF
+    DEPENDS "KernelHaveFPU;NOT KernelVerificationBuild"
+)
+
+config_string(KernelFPUEagerThreshold FPU_EAGER_THRESHOLD
+    "Number of consecutive time slices in which a thread takes an FPU fault before the\
+    kernel starts restoring its FPU state eagerly whenever it is switched to, avoiding\
+    the fault for threads that use the FPU on every timeslice. A time slice without an\
+    FPU fault resets the count, and eagerly switched threads are periodically switched\
+    lazily again so that threads that stop using the FPU no longer have it restored."
+    DEFAULT 5
+    DEPENDS "KernelFPUEager" UNDEF_DISABLED
+    UNQUOTE
+)
+
 config_option(KernelVerificationBuild VERIFICATION_BUILD
     "When enabled this configuration option prevents the usage of any other options that\
     would compromise the verification story of the kernel. Enabling this option does NOT\
@@ -193,6 +288,12 @@ config_string(KernelMaxNumTracePoints MAX_NUM_TRACE_POINTS
     DEPENDS "NOT KernelVerificationBuild;KernelBenchmarksTracepoints" DEFAULT_DISABLED 0
     UNQUOTE
 )
+config_option(KernelBenchmarkBootProfiling BENCHMARK_BOOT_PROFILING
+    "Timestamp the end of each phase of kernel initialisation on each core and \
+    report them to the initial thread in an extra bootinfo region."
+    DEFAULT OFF
+    DEPENDS "KernelEnableBenchmarks;KernelArchX86" DEFAULT_DISABLED OFF
+)
 # TODO: this config has no business being in the build system, and should
 # be moved to C headers, but for now must be emulated here for compatibility
 if(KernelBenchmarksTrackKernelEntries OR KernelBenchmarksTracepoints)
@@ -25,6 +25,11 @@ exception_t handleUnknownSyscall(word_t w);
 exception_t handleUserLevelFault(word_t w_a, word_t w_b);
 exception_t handleVMFaultEvent(vm_fault_type_t vm_faultType);
 
+#if defined(CONFIG_FASTPATH_VM_FAULT) || defined(CONFIG_FASTPATH_EXCEPTION_IPC)
+/* Returns if the fault in current_fault has to be sent by the slowpath */
+void fastpath_fault(void);
+#endif
+
 static inline word_t PURE
 getSyscallArg(word_t i, word_t* ipc_buffer)
 {
@@ -79,11 +79,17 @@ void vcpu_switch(vcpu_t *cpu);
 exception_t decodeVCPUWriteReg(cap_t cap, unsigned int length, word_t* buffer);
 exception_t decodeVCPUReadReg(cap_t cap, unsigned int length, bool_t call, word_t* buffer);
 exception_t decodeVCPUInjectIRQ(cap_t cap, unsigned int length, word_t* buffer);
+exception_t decodeVCPUReadRegsBatch(cap_t cap, unsigned int length, bool_t call, word_t* buffer);
+exception_t decodeVCPUWriteRegsBatch(cap_t cap, unsigned int length, word_t* buffer);
+exception_t decodeVCPUInjectIRQs(cap_t cap, unsigned int length, bool_t call, word_t* buffer);
 exception_t decodeVCPUSetTCB(cap_t cap, extra_caps_t extraCaps);
 
 exception_t invokeVCPUWriteReg(vcpu_t *vcpu, uint32_t field, uint32_t value);
 exception_t invokeVCPUReadReg(vcpu_t *vcpu, uint32_t field, bool_t call);
 exception_t invokeVCPUInjectIRQ(vcpu_t *vcpu, unsigned long index, virq_t virq);
+exception_t invokeVCPUReadRegsBatch(vcpu_t *vcpu, word_t count, uint32_t *fields, bool_t call);
+exception_t invokeVCPUWriteRegsBatch(vcpu_t *vcpu, word_t count, uint32_t *fields, uint32_t *values);
+exception_t invokeVCPUInjectIRQs(vcpu_t *vcpu, word_t count, virq_t *virqs, bool_t call);
 exception_t invokeVCPUSetTCB(vcpu_t *vcpu, tcb_t *tcb);
 
 #else /* end of CONFIG_ARM_HYPERVISOR_SUPPORT */
@@ -74,6 +74,9 @@ switchToThread_fp(tcb_t *thread, vspace_root_t *vroot, pde_t stored_hw_asid)
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     benchmark_utilisation_switch(NODE_STATE(ksCurThread), thread);
 #endif
+#ifdef CONFIG_THREAD_CPU_TIME
+    chargeCurThreadCPUTime();
+#endif
 
     NODE_STATE(ksCurThread) = thread;
 }
@@ -441,7 +441,8 @@ block asid_map_vspace {
 #ifdef CONFIG_VTX
 block asid_map_ept {
     field_high ept_root             48
-    padding                         14
+    padding                         13
+    field ad_enabled                1
     field type                      2
 }
 #endif
@@ -581,22 +582,45 @@ block ept_pml4e {
     field        read               1
 }
 
-block ept_pdpte {
+block ept_pdpte_1g {
+    padding                         13
+    field_high   page_base_address  21
+    padding                         18
+    field        avl_cte_depth      2
+    field        dirty              1
+    field        accessed           1
+    field        page_size          1
+    field        ignore_pat         1
+    field        type               3
+    field        execute            1
+    field        write              1
+    field        read               1
+}
+
+block ept_pdpte_pd {
     padding                         13
     field_high   pd_base_address    39
     field        avl_cte_depth      3
-    padding                         6
+    padding                         1
+    field        page_size          1
+    padding                         4
     field        execute            1
     field        write              1
     field        read               1
 }
 
+tagged_union ept_pdpte page_size {
+    tag ept_pdpte_pd 0
+    tag ept_pdpte_1g 1
+}
+
 block ept_pde_2m {
     padding                         13
     field_high   page_base_address  31
     padding                         8
     field        avl_cte_depth      2
-    padding                         2
+    field        dirty              1
+    field        accessed           1
     field        page_size          1
     field        ignore_pat         1
     field        type               3
@@ -626,7 +650,9 @@ block ept_pte {
     padding                         13
     field_high   page_base_address  39
     field        avl_cte_depth      2
-    padding                         3
+    field        dirty              1
+    field        accessed           1
+    padding                         1
     field        ignore_pat         1
     field        type               3
     field        execute            1
@@ -13,6 +13,7 @@
 
 #include <config.h>
 #ifdef CONFIG_ENABLE_BENCHMARKS
+#include <model/statedata.h>
 
 static inline uint64_t
 timestamp(void)
@@ -39,6 +40,11 @@ timestamp(void)
 
 static inline void benchmark_arch_utilisation_reset(void)
 {
+#if defined(CONFIG_X86_IDLE_MWAIT) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION)
+    ARCH_NODE_STATE(x86KSidleStats) = (x86_idle_stats_t) {
+        0
+    };
+#endif
 }
 
 #endif /* CONFIG_ENABLE_BENCHMARKS */
@@ -22,6 +22,7 @@ BOOT_CODE void apic_send_init_ipi(cpu_id_t cpu_id);
 BOOT_CODE void apic_send_startup_ipi(cpu_id_t cpu_id, paddr_t startup_addr);
 BOOT_CODE paddr_t apic_get_base_paddr(void);
 BOOT_CODE bool_t apic_init(bool_t mask_legacy_irqs);
+BOOT_CODE uint32_t apic_get_timer_khz(void);
 
 uint32_t apic_read_reg(apic_reg_t reg);
 void apic_write_reg(apic_reg_t reg, uint32_t val);
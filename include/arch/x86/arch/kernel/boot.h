@@ -26,6 +26,7 @@ typedef struct ui_info {
     p_region_t p_reg;     /* region where the userland image lies in */
     sword_t    pv_offset; /* UI virtual address + pv_offset = UI physical address */
     vptr_t     v_entry;   /* entry point (virtual address) of userland image */
+    p_region_t pad_p_reg; /* memory skipped below the image to align it for large frames */
 } ui_info_t;
 
 cap_t create_unmapped_it_frame_cap(pptr_t pptr, bool_t use_large);
@@ -43,7 +44,12 @@ bool_t init_sys_state(
     acpi_rsdp_t      *acpi_rsdp,
     seL4_X86_BootInfo_VBE *vbe,
     seL4_X86_BootInfo_mmap_t *mb_mmap,
-    seL4_X86_BootInfo_fb_t *fb_info
+    seL4_X86_BootInfo_fb_t *fb_info,
+    uint32_t      num_cpus,
+    cpu_id_t     *cpus
+#ifdef CONFIG_NUMA
+    , acpi_numa_info_t *numa_info
+#endif
 );
 
 bool_t init_cpu(
@@ -42,6 +42,7 @@ typedef struct EPTPageTableMapped_ret EPTPageTableMapped_ret_t;
 struct findEPTForASID_ret {
     exception_t status;
     ept_pml4e_t *ept;
+    bool_t ad_enabled;
 };
 typedef struct findEPTForASID_ret findEPTForASID_ret_t;
 
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#ifndef __ARCH_KERNEL_IDLE_H_
+#define __ARCH_KERNEL_IDLE_H_
+
+#include <config.h>
+#include <types.h>
+#include <linker.h>
+
+#ifdef CONFIG_X86_IDLE_MWAIT
+
+/* MWAIT supports hints for C1 to C8, of which CPUID only enumerates up to C7 */
+#define X86_IDLE_MAX_STATES 7
+
+/* The idle thread cannot access per core state, so the governor passes the MWAIT
+ * hint for the next idle period to it in this register */
+#ifdef CONFIG_ARCH_X86_64
+#define idleHintRegister RSI
+#else
+#define idleHintRegister ESI
+#endif
+
+typedef struct x86_idle_state {
+    /* MWAIT hint, the C-state minus one in bits 7:4 and the sub-state in bits 3:0 */
+    word_t hint;
+    /* Predicted idle period in TSC cycles required to select this state */
+    uint64_t target_residency;
+} x86_idle_state_t;
+
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+typedef struct x86_idle_stats {
+    /* Number of idle periods and the TSC cycles spent in them */
+    uint64_t entries;
+    uint64_t residency;
+    /* Number of idle periods that used a C-state deeper than C1 */
+    uint64_t deep_entries;
+    /* Number of idle periods ended by an IPI from another core, and the
+     * total TSC cycles from sending the IPI until this core entered the kernel */
+    uint64_t ipi_wakeups;
+    uint64_t wake_latency;
+} x86_idle_stats_t;
+#endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+BOOT_CODE void x86_idle_init(uint32_t tsc_mhz);
+void x86_idle_enter(void);
+void x86_idle_wake(void);
+#if defined(ENABLE_SMP_SUPPORT) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION)
+void x86_idle_mark_wake_request(word_t mask);
+#endif
+
+#endif /* CONFIG_X86_IDLE_MWAIT */
+
+#endif /* __ARCH_KERNEL_IDLE_H_ */
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#ifndef __ARCH_KERNEL_KERNELINFO_H_
+#define __ARCH_KERNEL_KERNELINFO_H_
+
+#include <config.h>
+#include <types.h>
+#include <linker.h>
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+
+BOOT_CODE bool_t x86_kernel_info_init(cap_t root_cnode_cap, seL4_BootInfo_KernelInfo_t *bi,
+                                      uint32_t tsc_mhz);
+void x86_kernel_info_wake(void);
+void x86_kernel_info_exit(void);
+
+#endif /* CONFIG_KERNEL_INFO_PAGE */
+
+#endif /* __ARCH_KERNEL_KERNELINFO_H_ */
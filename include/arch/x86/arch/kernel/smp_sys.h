@@ -21,7 +21,7 @@
 #define BOOT_NODE_MAX_PADDR 0x7bff
 
 #ifdef ENABLE_SMP_SUPPORT
-void boot_node(void);
+void boot_node(cpu_id_t cpu_index);
 BOOT_CODE void start_boot_aps(void);
 BOOT_CODE bool_t copy_boot_code_aps(uint32_t mem_lower);
 #endif /* ENABLE_SMP_SUPPORT */
@@ -13,13 +13,34 @@
 
 #include <config.h>
 #include <util.h>
+#include <model/statedata.h>
+#include <arch/kernel/idle.h>
+#include <arch/kernel/kernelinfo.h>
 
 static inline void arch_c_entry_hook(void)
 {
+#ifdef CONFIG_X86_IDLE_MWAIT
+    if (NODE_STATE(ksCurThread) == NODE_STATE(ksIdleThread)) {
+        x86_idle_wake();
+    }
+#endif
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    if (NODE_STATE(ksCurThread) == NODE_STATE(ksIdleThread)) {
+        x86_kernel_info_wake();
+    }
+#endif
 }
 
 static inline void arch_c_exit_hook(void)
 {
+#ifdef CONFIG_X86_IDLE_MWAIT
+    if (NODE_STATE(ksCurThread) == NODE_STATE(ksIdleThread)) {
+        x86_idle_enter();
+    }
+#endif
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    x86_kernel_info_exit();
+#endif
 }
 
 void c_handle_syscall(word_t cptr, word_t msgInfo, syscall_t syscall)
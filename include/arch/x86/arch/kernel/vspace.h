@@ -68,7 +68,7 @@ void map_it_pd_cap(cap_t vspace_cap, cap_t pd_cap);
 void map_it_frame_cap(cap_t vspace_cap, cap_t frame_cap);
 void write_it_asid_pool(cap_t it_ap_cap, cap_t it_vspace_cap);
 bool_t init_pat_msr(void);
-cap_t create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg);
+cap_t create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg, v_region_t large_v_reg);
 
 /* ==================== BOOT CODE FINISHES HERE ==================== */
 
@@ -96,7 +96,7 @@ findVSpaceForASID_ret_t findVSpaceForASID(asid_t asid);
 
 void unmapPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, void *pptr);
 void modeUnmapPage(vm_page_size_t page_size, vspace_root_t *vroot, vptr_t vptr, void *pptr);
-exception_t decodeX86ModeMapRemapPage(word_t invLabel, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vptr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr);
+exception_t decodeX86ModeMapRemapPage(word_t invLabel, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vptr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr, bool_t restartCaller);
 void setVMRoot(tcb_t *tcb);
 bool_t CONST isValidVTableRoot(cap_t cap);
 bool_t CONST isValidNativeRoot(cap_t cap);
@@ -114,6 +114,11 @@ exception_t decodeIA32PageDirectoryInvocation(word_t invLabel, word_t length, ct
 
 /* common functions for x86 */
 exception_t decodeX86FrameInvocation(word_t invLabel, word_t length, cte_t *cte, cap_t cap, extra_caps_t excaps, word_t *buffer);
+exception_t decodeX86FrameMap(cap_t cap, cte_t *cte, cap_t vspaceCap, vptr_t vaddr, word_t w_rightsMask,
+                              vm_attributes_t vmAttr, bool_t restartCaller);
+#ifdef CONFIG_X86_FAULT_REPLY_MAP
+void handleVMFaultReplyMap(tcb_t *receiver, tcb_t *sender);
+#endif
 
 uint32_t CONST WritableFromVMRights(vm_rights_t vm_rights);
 uint32_t CONST SuperUserFromVMRights(vm_rights_t vm_rights);
@@ -32,7 +32,7 @@
 #define IA32_FMASK_MSR          0xC0000084
 #define IA32_EFER_MSR 0xC0000080
 #define IA32_PLATFORM_INFO_MSR  0xCE
-#define IA32_XSS_MSR            0xD0A
+#define IA32_XSS_MSR            0xDA0
 #define IA32_FEATURE_CONTROL_MSR 0x3A
 #define IA32_KERNEL_GS_BASE_MSR 0xC0000102
 #define IA32_VMX_BASIC_MSR      0x480
@@ -197,6 +197,15 @@ static inline uint64_t x86_rdtsc(void)
     return ((uint64_t) hi) << 32llu | (uint64_t) lo;
 }
 
+#ifdef CONFIG_THREAD_CPU_TIME
+/* Thread CPU time is counted in TSC cycles. RDTSC is not ordered with respect
+ * to the surrounding instructions, which is precise enough for accounting */
+static inline uint64_t getCPUTimestamp(void)
+{
+    return x86_rdtsc();
+}
+#endif /* CONFIG_THREAD_CPU_TIME */
+
 #ifdef ENABLE_SMP_SUPPORT
 static inline void arch_pause(void)
 {
@@ -224,6 +233,10 @@ typedef struct _cpu_identity {
      * Intel uses.
      */
     x86_cpu_identity_t display;
+
+    /* Number of low bits of the APIC ID that identify the SMT thread within
+     * a core, and the SMT thread and core within a package */
+    uint8_t smt_shift, core_shift;
 } cpu_identity_t;
 
 /* This, and all its adjoint routines will be called at init time; see boot.c */
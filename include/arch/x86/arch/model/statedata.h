@@ -20,6 +20,8 @@
 #include <arch/object/vcpu.h>
 #include <arch/object/iospace.h>
 #include <plat/machine.h>
+#include <arch/kernel/idle.h>
+#include <bootinfo.h>
 
 #include <mode/model/statedata.h>
 
@@ -52,6 +54,25 @@ NODE_STATE_DECLARE(word_t, x86KSCurrentGSBase);
  * back to NULL */
 NODE_STATE_DECLARE(word_t, x86KSGPExceptReturnTo);
 
+#ifdef CONFIG_X86_IDLE_MWAIT
+/* Time the idle thread was last resumed and the moving average of the length
+ * of idle periods, both in TSC cycles */
+NODE_STATE_DECLARE(uint64_t, x86KSidleEnterTime);
+NODE_STATE_DECLARE(uint64_t, x86KSidlePredicted);
+/* Index into x86KSidleStates of the state selected for the current idle period */
+NODE_STATE_DECLARE(word_t, x86KSidleState);
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+/* Time at which another core sent an IPI to wake this idle core, or zero */
+NODE_STATE_DECLARE(uint64_t, x86KSidleWakeRequest);
+NODE_STATE_DECLARE(x86_idle_stats_t, x86KSidleStats);
+#endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+#endif /* CONFIG_X86_IDLE_MWAIT */
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+/* TSC at which the idle thread was last resumed */
+NODE_STATE_DECLARE(uint64_t, x86KSkernelInfoIdleStart);
+#endif
+
 NODE_STATE_TYPE_DECLARE(modeNodeState, mode);
 NODE_STATE_END(archNodeState);
 
@@ -91,4 +112,15 @@ extern uint16_t x86KSdebugPort;
 
 extern x86_irq_state_t x86KSIRQState[];
 
+#ifdef CONFIG_X86_IDLE_MWAIT
+extern x86_idle_state_t x86KSidleStates[X86_IDLE_MAX_STATES];
+extern word_t x86KSidleNumStates;
+extern word_t x86KSidleTscPerApicTick;
+extern word_t x86KSidleMonitorLine;
+#endif
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+extern seL4_KernelInfo *x86KSkernelInfo;
+#endif
+
 #endif
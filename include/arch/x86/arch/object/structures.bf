@@ -268,6 +268,18 @@ block vmx_data_exit_qualification_control_regster {
     field cr            4
 }
 
+-- This is the layout of the data exit qualification register
+-- when the exit reason is 'IO'
+block vmx_data_exit_qualification_io {
+    field port              16
+    padding                 9
+    field operand_encoding  1
+    field rep               1
+    field string            1
+    field direction         1
+    field size              3
+}
+
 #endif
 
 block ia32_arch_capabilities_msr {
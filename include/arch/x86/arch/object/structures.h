@@ -35,6 +35,11 @@ typedef struct arch_tcb {
      * tcb->tcbVCPU->vcpuTCB == tcb. */
     struct vcpu *tcbVCPU;
 #endif /* CONFIG_VTX */
+#ifdef CONFIG_X86_FAULT_REPLY_MAP
+    /* Set when the frame given with the last reply to a VM fault could not be
+     * mapped, and reported with the next VM fault of the thread */
+    bool_t tcbVMFaultReplyMapFailed;
+#endif /* CONFIG_X86_FAULT_REPLY_MAP */
 } arch_tcb_t;
 
 struct user_data {
@@ -15,11 +15,14 @@
 
 #include <config.h>
 #include <api/failures.h>
+#include <arch/api/vmenter.h>
 
 #define VCPU_VMCS_SIZE 4096
 #define VCPU_IOBITMAP_SIZE 8192
+#define VCPU_VIRTUAL_APIC_SIZE 4096
 
 #define VMX_CONTROL_VPID 0x00000000
+#define VMX_CONTROL_POSTED_INTERRUPT_VECTOR 0x00000002
 
 #define VMX_GUEST_ES_SELECTOR 0x00000800
 #define VMX_GUEST_CS_SELECTOR 0x00000802
@@ -29,6 +32,7 @@
 #define VMX_GUEST_GS_SELECTOR 0x0000080A
 #define VMX_GUEST_LDTR_SELECTOR 0x0000080C
 #define VMX_GUEST_TR_SELECTOR 0x0000080E
+#define VMX_GUEST_INTERRUPT_STATUS 0x00000810
 
 #define VMX_HOST_ES_SELECTOR 0x00000C00
 #define VMX_HOST_CS_SELECTOR 0x00000C02
@@ -48,7 +52,12 @@
 #define VMX_CONTROL_TSC_OFFSET 0x00002010
 #define VMX_CONTROL_VIRTUAL_APIC_ADDRESS 0x00002012
 #define VMX_CONTROL_APIC_ACCESS_ADDRESS 0x00002014
+#define VMX_CONTROL_POSTED_INTERRUPT_DESC_ADDRESS 0x00002016
 #define VMX_CONTROL_EPT_POINTER 0x0000201A
+#define VMX_CONTROL_EOI_EXIT_BITMAP0 0x0000201C
+#define VMX_CONTROL_EOI_EXIT_BITMAP1 0x0000201E
+#define VMX_CONTROL_EOI_EXIT_BITMAP2 0x00002020
+#define VMX_CONTROL_EOI_EXIT_BITMAP3 0x00002022
 
 #define VMX_DATA_GUEST_PHYSICAL 0x00002400
 
@@ -218,6 +227,7 @@ enum exit_reasons {
     /* 0x2A */
     TPR_BELOW_THRESHOLD = 0x2B,
     APIC_ACCESS = 0x2C,
+    VIRTUALIZED_EOI = 0x2D,
     GDTR_OR_IDTR = 0x2E,
     LDTR_OR_TR = 0x2F,
     EPT_VIOLATION = 0x30,
@@ -227,7 +237,8 @@ enum exit_reasons {
     VMX_PREEMPTION_TIMER = 0x34,
     INVVPID = 0x35,
     WBINVD = 0x36,
-    XSETBV = 0x37
+    XSETBV = 0x37,
+    APIC_WRITE = 0x38
 };
 
 #define VPID_INVALID 0
@@ -257,12 +268,64 @@ typedef enum vcpu_gp_register vcpu_gp_register_t;;
 
 const vcpu_gp_register_t crExitRegs[];
 
+/* Entries of the exit policy table. Each entry describes an exit that the
+ * kernel will complete on behalf of the VCPU owner */
+typedef struct vcpu_cpuid_exit {
+    word_t flags;
+    uint32_t leaf;
+    uint32_t subleaf;
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+} vcpu_cpuid_exit_t;
+
+typedef struct vcpu_msr_exit {
+    word_t flags;
+    uint32_t msr;
+    uint64_t value;
+} vcpu_msr_exit_t;
+
+typedef struct vcpu_io_exit {
+    word_t flags;
+    uint16_t port;
+    uint32_t value;
+} vcpu_io_exit_t;
+
+/* Posted-interrupt descriptor, as defined by the hardware. The first 256 bits are
+ * the posted-interrupt requests, one per vector */
+typedef struct vcpu_pi_desc {
+    uint32_t pir[8];
+    uint32_t control;
+    uint32_t ndst;
+    uint32_t reserved[6];
+} vcpu_pi_desc_t;
+
+#define VCPU_PI_DESC_ON BIT(0)
+#define VCPU_PI_DESC_NV_SHIFT 16
+
+/* Offset of the interrupt request register in the virtual-APIC page. Each 32-bit
+ * word of the register is 16 byte aligned */
+#define VCPU_VAPIC_IRR 0x200
+
+typedef struct vcpu_exit_policy {
+    vcpu_cpuid_exit_t cpuid[SEL4_VMEXIT_POLICY_NUM_CPUID];
+    vcpu_msr_exit_t msr[SEL4_VMEXIT_POLICY_NUM_MSR];
+    vcpu_io_exit_t io[SEL4_VMEXIT_POLICY_NUM_IOPORT];
+} vcpu_exit_policy_t;
+
 struct vcpu {
     /* Storage for VMCS region. First field of vcpu_t so they share address.
      * Will use at most 4KiB of memory. Statically reserve 4KiB for convenience. */
     char vmcs[VCPU_VMCS_SIZE];
     word_t io[VCPU_IOBITMAP_SIZE / sizeof(word_t)];
 
+    /* Virtual-APIC page used by the hardware for APIC virtualisation. This and
+     * the posted-interrupt descriptor are only used once the VCPU owner has
+     * performed EnableVirtualAPIC */
+    char virtual_apic[VCPU_VIRTUAL_APIC_SIZE];
+    vcpu_pi_desc_t pi_desc;
+
     /* Place the fpu state here so that it is aligned */
     user_fpu_state_t fpuState;
 
@@ -301,8 +364,24 @@ struct vcpu {
     word_t cached_cr0_mask;
     word_t cached_cr0;
 
-    /* Last used EPT root */
-    word_t last_ept_root;
+    /* Last EPT pointer written to the VMCS */
+    word_t last_eptp;
+
+    /* Exits that the VCPU owner has asked the kernel to complete without
+     * returning from VMEnter */
+    vcpu_exit_policy_t exit_policy;
+
+    /* Additional VMCS fields to return in the message registers on every exit */
+    word_t exit_snapshot[SEL4_VMCS_BATCH_MAX_FIELDS];
+    word_t exit_snapshot_count;
+
+    /* Whether APIC virtualisation and posted interrupts are enabled */
+    bool_t virtual_apic_enabled;
+
+    /* Guest vector to post for each bit of a badge signalled to the bound
+     * notification of the VCPU's TCB. Only bits in posted_badge_mask are valid */
+    uint8_t posted_vector[wordBits];
+    word_t posted_badge_mask;
 
 #ifndef CONFIG_KERNEL_SKIM_WINDOW
     /* Last set host cr3 */
@@ -319,6 +398,10 @@ typedef struct vcpu vcpu_t;
 compile_assert(vcpu_size_sane, sizeof(vcpu_t) <= BIT(seL4_X86_VCPUBits))
 unverified_compile_assert(vcpu_fpu_state_alignment_valid,
                           OFFSETOF(vcpu_t, fpuState) % MIN_FPU_ALIGNMENT == 0)
+unverified_compile_assert(vcpu_virtual_apic_alignment_valid,
+                          OFFSETOF(vcpu_t, virtual_apic) % VCPU_VIRTUAL_APIC_SIZE == 0)
+unverified_compile_assert(vcpu_pi_desc_alignment_valid,
+                          OFFSETOF(vcpu_t, pi_desc) % 64 == 0)
 
 /* Initializes a VCPU object with default values. A VCPU object that is not inititlized
  * must not be run/loaded with vmptrld */
@@ -353,7 +436,14 @@ void clearCurrentVCPU(void);
 void VMCheckBoundNotification(tcb_t *tcb);
 #endif /* ENABLE_SMP_SUPPORT */
 
+/* Posts any bits of the badge that the VCPU of the given TCB has mapped to guest
+ * vectors as interrupts directly to the guest. Returns the bits of the badge that
+ * were not posted and must be delivered through the bound notification */
+word_t vcpu_post_notification(tcb_t *tcb, word_t badge);
+
 void invept(ept_pml4e_t *ept_pml4);
+bool_t vtx_ept_1g_supported(void);
+bool_t vtx_ept_ad_supported(void);
 
 /* Removes any IO port mappings that have been cached for the given VPID */
 void clearVPIDIOPortMappings(vpid_t vpid, uint16_t first, uint16_t last);
@@ -37,5 +37,6 @@ typedef struct v_region {
 
 #define REG_EMPTY (region_t){ .start = 0, .end = 0 }
 #define P_REG_EMPTY (p_region_t){ .start = 0, .end = 0 }
+#define V_REG_EMPTY (v_region_t){ .start = 0, .end = 0 }
 
 #endif /* __BASIC_TYPES_H */
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#ifndef BENCHMARK_BOOT_H
+#define BENCHMARK_BOOT_H
+
+#include <config.h>
+#include <types.h>
+#include <bootinfo.h>
+#include <arch/benchmark.h>
+
+#ifdef CONFIG_BENCHMARK_BOOT_PROFILING
+
+#define BENCHMARK_BOOT_PROFILE_SIZE (sizeof(seL4_BootInfo_Profile_t) + \
+                                     CONFIG_MAX_NUM_NODES * sizeof(seL4_Uint64[seL4_NumBootPhases]))
+
+extern timestamp_t ksBootPhaseEnd[CONFIG_MAX_NUM_NODES][seL4_NumBootPhases];
+
+/* Record the end of a boot phase on a node. The node index is passed
+ * explicitly as it is needed before the current node can be determined */
+static inline void
+benchmark_boot_phase(word_t node, seL4_BootPhase phase)
+{
+    ksBootPhaseEnd[node][phase] = timestamp();
+}
+
+void benchmark_boot_init_bi(seL4_BootInfo_Profile_t *profile);
+void benchmark_boot_finalise(void);
+
+#else
+
+#define BENCHMARK_BOOT_PROFILE_SIZE 0
+
+static inline void
+benchmark_boot_phase(word_t node, seL4_BootPhase phase)
+{
+}
+
+#endif /* CONFIG_BENCHMARK_BOOT_PROFILING */
+
+#endif /* BENCHMARK_BOOT_H */
@@ -29,6 +29,20 @@ extern timestamp_t benchmark_end_time;
 
 void benchmark_track_utilisation_dump(void);
 
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+extern uint64_t benchmark_vcpu_switches;
+extern uint64_t benchmark_vcpu_switch_time;
+
+/* Account for a VCPU switch that started at 'start' */
+static inline void benchmark_utilisation_vcpu_switch(timestamp_t start)
+{
+    if (likely(benchmark_log_utilisation_enabled)) {
+        benchmark_vcpu_switches++;
+        benchmark_vcpu_switch_time += (timestamp_t)(timestamp() - start);
+    }
+}
+#endif /* CONFIG_ARM_HYPERVISOR_SUPPORT */
+
 void benchmark_track_reset_utilisation(void);
 /* Calculate and add the utilisation time from when the heir started to run i.e. scheduled
  * and until it's being kicked off
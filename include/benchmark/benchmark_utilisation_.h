@@ -20,6 +20,10 @@
 typedef struct {
     timestamp_t schedule_start_time;
     uint64_t    utilisation;
+#ifdef CONFIG_HAVE_FPU
+    uint64_t    fpu_faults;
+    uint64_t    fpu_eager_restores;
+#endif
 } benchmark_util_t;
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
 
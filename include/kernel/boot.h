@@ -79,9 +79,12 @@ create_frames_of_region(
     cap_t    pd_cap,
     region_t reg,
     bool_t   do_map,
-    sword_t  pv_offset
+    sword_t  pv_offset,
+    bool_t   use_large
 );
 
+v_region_t large_frames_of_region(region_t reg, sword_t pv_offset);
+
 cap_t
 create_it_pd_pts(
     cap_t      root_cnode_cap,
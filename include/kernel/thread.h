@@ -87,6 +87,19 @@ isHighestPrio(word_t dom, prio_t prio)
            prio >= getHighestPrio(dom);
 }
 
+#ifdef CONFIG_THREAD_CPU_TIME
+/* Charge the current thread with the time since it was switched to. Time
+ * spent in the kernel is charged to the thread that was running on entry */
+static inline void
+chargeCurThreadCPUTime(void)
+{
+    uint64_t now = getCPUTimestamp();
+
+    NODE_STATE(ksCurThread)->tcbCPUTime += now - NODE_STATE(ksCurThreadStart);
+    NODE_STATE(ksCurThreadStart) = now;
+}
+#endif /* CONFIG_THREAD_CPU_TIME */
+
 void configureIdleThread(tcb_t *tcb);
 void activateThread(void);
 void suspend(tcb_t *target);
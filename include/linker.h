@@ -26,6 +26,11 @@
 /* node-local bss data that is only used during kernel bootstrapping */
 #define BOOT_BSS SECTION(".boot.bss")
 
+/* code on the common kernel entry and IPC paths. This is grouped together after
+ * the fastpath, away from boot and decode code, to reduce the instruction cache
+ * and TLB footprint of the slowpath */
+#define HOT_CODE SECTION(".text.hot")
+
 /* data will be aligned to n bytes in a special BSS section */
 #define ALIGN_BSS(n) ALIGN(n) SECTION(".bss.aligned")
 
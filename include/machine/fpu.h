@@ -28,6 +28,11 @@ exception_t handleFPUFault(void);
 
 void switchLocalFpuOwner(user_fpu_state_t *new_owner);
 
+#ifdef CONFIG_FPU_EAGER
+/* Give the FPU to a thread that is expected to use it. */
+void eagerFPURestore(tcb_t *thread);
+#endif
+
 /* Switch the current owner of the FPU state on the core specified by 'cpu'. */
 void switchFpuOwner(user_fpu_state_t *new_owner, word_t cpu);
 
@@ -38,8 +43,66 @@ static inline bool_t nativeThreadUsingFPU(tcb_t *thread)
            NODE_STATE_ON_CORE(ksActiveFPUState, thread->tcbAffinity);
 }
 
+#ifdef CONFIG_FPU_EAGER
+/* A thread's FPU usage is judged per time slice, which starts when it returns
+ * to user level on a core after a different thread did. The count in
+ * tcbFPUUsage is the number of consecutive lazily switched slices in which
+ * the thread took an FPU fault, and a lazy slice without a fault resets it.
+ * Once it reaches CONFIG_FPU_EAGER_THRESHOLD the FPU is restored eagerly at
+ * the start of the next FPU_EAGER_SLICES slices, after which a single slice
+ * is switched lazily again to check that the thread still uses the FPU. */
+#define FPU_EAGER_SLICES 16
+/* The thread took an FPU fault in the current slice */
+#define FPU_USAGE_FAULTED BIT(wordBits - 1)
+/* The current slice was switched eagerly */
+#define FPU_USAGE_EAGER BIT(wordBits - 2)
+#define FPU_USAGE_COUNT MASK(wordBits - 2)
+
+static inline void fpuUsageFault(tcb_t *thread)
+{
+    word_t usage = thread->tcbFPUUsage;
+    word_t count = usage & FPU_USAGE_COUNT;
+
+    if (count < CONFIG_FPU_EAGER_THRESHOLD) {
+        count++;
+        if (count == CONFIG_FPU_EAGER_THRESHOLD) {
+            count += FPU_EAGER_SLICES;
+        }
+    }
+    thread->tcbFPUUsage = count | (usage & FPU_USAGE_EAGER) | FPU_USAGE_FAULTED;
+}
+
+/* Account for the end of the previous slice of a thread and return whether
+ * the FPU should be restored eagerly for the slice that is starting */
+static inline bool_t fpuUsageSliceStart(tcb_t *thread)
+{
+    word_t usage = thread->tcbFPUUsage;
+    word_t count = usage & FPU_USAGE_COUNT;
+
+    if (!(usage & (FPU_USAGE_FAULTED | FPU_USAGE_EAGER))) {
+        /* The previous slice was switched lazily and did not use the FPU */
+        count = 0;
+    }
+    if (count >= CONFIG_FPU_EAGER_THRESHOLD) {
+        thread->tcbFPUUsage = (count - 1) | FPU_USAGE_EAGER;
+        return true;
+    }
+    thread->tcbFPUUsage = count;
+    return false;
+}
+#endif /* CONFIG_FPU_EAGER */
+
 static inline void FORCE_INLINE lazyFPURestore(tcb_t *thread)
 {
+#ifdef CONFIG_FPU_EAGER
+    if (unlikely(thread != NODE_STATE(ksFPULastThread))) {
+        NODE_STATE(ksFPULastThread) = thread;
+        if (fpuUsageSliceStart(thread) && !nativeThreadUsingFPU(thread)) {
+            eagerFPURestore(thread);
+            return;
+        }
+    }
+#endif
     if (unlikely(NODE_STATE(ksActiveFPUState))) {
         /* If we have enabled/disabled the FPU too many times without
          * someone else trying to use it, we assume it is no longer
@@ -66,7 +66,15 @@ NODE_STATE_BEGIN(nodeState)
 NODE_STATE_DECLARE(tcb_queue_t, ksReadyQueues[NUM_READY_QUEUES]);
 NODE_STATE_DECLARE(word_t, ksReadyQueuesL1Bitmap[CONFIG_NUM_DOMAINS]);
 NODE_STATE_DECLARE(word_t, ksReadyQueuesL2Bitmap[CONFIG_NUM_DOMAINS][L2_BITMAP_SIZE]);
+#ifdef CONFIG_KERNEL_INFO_PAGE
+/* Number of threads in the ready queues */
+NODE_STATE_DECLARE(word_t, ksReadyThreads);
+#endif
 NODE_STATE_DECLARE(tcb_t, *ksCurThread);
+#ifdef CONFIG_THREAD_CPU_TIME
+/* Time at which ksCurThread was switched to */
+NODE_STATE_DECLARE(uint64_t, ksCurThreadStart);
+#endif
 NODE_STATE_DECLARE(tcb_t, *ksIdleThread);
 NODE_STATE_DECLARE(tcb_t, *ksSchedulerAction);
 
@@ -75,6 +83,10 @@ NODE_STATE_DECLARE(tcb_t, *ksSchedulerAction);
 NODE_STATE_DECLARE(user_fpu_state_t *, ksActiveFPUState);
 /* Number of times we have restored a user context with an active FPU without switching it */
 NODE_STATE_DECLARE(word_t, ksFPURestoresSinceSwitch);
+#ifdef CONFIG_FPU_EAGER
+/* Thread that last returned to user level, used to detect the start of a time slice */
+NODE_STATE_DECLARE(tcb_t *, ksFPULastThread);
+#endif
 #endif /* CONFIG_HAVE_FPU */
 #ifdef CONFIG_DEBUG_BUILD
 NODE_STATE_DECLARE(tcb_t *, ksDebugTCBs);
@@ -248,10 +248,21 @@ struct tcb {
     struct tcb* tcbEPNext;
     struct tcb* tcbEPPrev;
 
+#ifdef CONFIG_FPU_EAGER
+    /* Consecutive time slices in which the thread used the FPU and whether
+     * it did so in the current one, see fpuUsageSliceStart, 1 word */
+    word_t tcbFPUUsage;
+#endif /* CONFIG_FPU_EAGER */
+
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     benchmark_util_t benchmark;
 #endif
 
+#ifdef CONFIG_THREAD_CPU_TIME
+    /* CPU time consumed up to the last switch away from this thread, 8 bytes */
+    uint64_t tcbCPUTime;
+#endif /* CONFIG_THREAD_CPU_TIME */
+
 #ifdef CONFIG_DEBUG_BUILD
     /* Pointers for list of all tcbs that is maintained
      * when CONFIG_DEBUG_BUILD is enabled */
@@ -40,4 +40,7 @@ exception_t invokeUntyped_Retype(cte_t *srcSlot, bool_t reset,
                                  void* retypeBase, object_t newType,
                                  word_t userSize, slot_range_t destSlots,
                                  bool_t deviceMemory);
+#ifdef CONFIG_UNTYPED_RECLAIM_LAST
+void reclaimUntypedObject(cte_t *slot);
+#endif
 #endif
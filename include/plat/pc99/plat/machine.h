@@ -37,6 +37,11 @@ typedef enum _interrupt_t {
 #ifdef ENABLE_SMP_SUPPORT
     int_remote_call_ipi         = 158,
     int_reschedule_ipi          = 159,
+#endif
+#ifdef CONFIG_VTX
+    int_vtx_posted_interrupt    = 160,
+    int_irq_max                 = 160, /* int_vtx_posted_interrupt is the max irq */
+#elif defined ENABLE_SMP_SUPPORT
     int_irq_max                 = 159, /* int_reschedule_ipi is the max irq */
 #else
     int_irq_max                 = 157, /* int_timer is the max irq */
@@ -59,6 +64,9 @@ typedef enum _platform_irq_t {
 #ifdef ENABLE_SMP_SUPPORT
     irq_remote_call_ipi         = int_remote_call_ipi - IRQ_INT_OFFSET,
     irq_reschedule_ipi          = int_reschedule_ipi  - IRQ_INT_OFFSET,
+#endif
+#ifdef CONFIG_VTX
+    irq_vtx_posted_interrupt    = int_vtx_posted_interrupt - IRQ_INT_OFFSET,
 #endif
     maxIRQ                      = int_irq_max         - IRQ_INT_OFFSET,
     /* This is explicitly 255, instead of -1 like on some other platforms, to ensure
@@ -90,4 +90,33 @@ bool_t acpi_fadt_scan(
     acpi_rsdp_t* acpi_rsdp
 );
 
+#ifdef CONFIG_NUMA
+#define MAX_NUM_NUMA_MEM_REGIONS 16
+#define NUMA_NODE_INVALID 0xff
+
+typedef struct acpi_numa_mem_region {
+    paddr_t  start;
+    paddr_t  end;
+    uint32_t node;
+} acpi_numa_mem_region_t;
+
+typedef struct acpi_numa_info {
+    /* number of NUMA nodes, 0 if the platform provides no SRAT */
+    uint32_t num_nodes;
+    uint32_t num_mem_regions;
+    acpi_numa_mem_region_t mem_regions[MAX_NUM_NUMA_MEM_REGIONS];
+    /* NUMA node of each CPU in the list given to acpi_numa_scan */
+    uint8_t  cpu_node[CONFIG_MAX_NUM_NODES];
+    /* relative distance between NUMA nodes from the SLIT, 10 being local */
+    uint8_t  distance[CONFIG_MAX_NUM_NUMA_NODES][CONFIG_MAX_NUM_NUMA_NODES];
+} acpi_numa_info_t;
+
+void acpi_numa_scan(
+    acpi_rsdp_t*      acpi_rsdp,
+    cpu_id_t*         cpu_list,
+    uint32_t          num_cpu,
+    acpi_numa_info_t* numa_info
+);
+#endif /* CONFIG_NUMA */
+
 #endif
@@ -33,6 +33,14 @@ handleReservedIRQ(irq_t irq)
         return;
     }
 #endif
+#ifdef CONFIG_VTX
+    if (irq == irq_vtx_posted_interrupt) {
+        /* A posted interrupt notification that arrived whilst this core was not
+         * running the guest. The posted interrupts are moved into the guest's
+         * virtual APIC the next time it is entered, so there is nothing to do */
+        return;
+    }
+#endif
 }
 
 static inline void
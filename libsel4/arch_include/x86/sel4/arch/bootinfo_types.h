@@ -137,4 +137,44 @@ typedef struct seL4_X86_BootInfo_mmap {
 
 typedef struct multiboot2_fb seL4_X86_BootInfo_fb_t;
 
+/* Position of a node in the processor topology, decoded from its APIC ID */
+typedef struct seL4_X86_NodeTopology {
+    seL4_Uint32 apicID;
+    seL4_Uint32 package;
+    /* core within the package */
+    seL4_Uint32 core;
+    /* SMT thread within the core */
+    seL4_Uint32 thread;
+} SEL4_PACKED seL4_X86_NodeTopology_t;
+
+/**
+ * Processor topology of each seL4 node, indexed by nodeID. Nodes with the
+ * same package and core are SMT siblings that share execution resources.
+ */
+typedef struct seL4_X86_BootInfo_Topology {
+    seL4_BootInfoHeader header;
+    seL4_Uint32 numNodes;
+    seL4_X86_NodeTopology_t nodes[CONFIG_MAX_NUM_NODES];
+} SEL4_PACKED seL4_X86_BootInfo_Topology_t;
+
+#ifdef CONFIG_NUMA
+#define SEL4_X86_NUMA_NODE_INVALID 0xff
+
+/**
+ * NUMA topology as described by the ACPI SRAT and SLIT. Untypeds
+ * created from RAM never span more than one NUMA node.
+ */
+typedef struct seL4_X86_BootInfo_NUMA {
+    seL4_BootInfoHeader header;
+    seL4_Uint32 numNUMANodes;
+    /* NUMA node of each seL4 node, indexed by nodeID */
+    seL4_Uint8 cpuNode[CONFIG_MAX_NUM_NODES];
+    /* relative distance between NUMA nodes, 10 being local */
+    seL4_Uint8 distance[CONFIG_MAX_NUM_NUMA_NODES][CONFIG_MAX_NUM_NUMA_NODES];
+    /* NUMA node of each untyped in the untypedList of the bootinfo, or
+     * SEL4_X86_NUMA_NODE_INVALID if it is not known or not unique */
+    seL4_Uint8 untypedNode[CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS];
+} SEL4_PACKED seL4_X86_BootInfo_NUMA_t;
+#endif /* CONFIG_NUMA */
+
 #endif // __LIBSEL4_ARCH_BOOTINFO_TYPES_H
@@ -30,7 +30,7 @@
 #define MSI_MIN VECTOR_MIN
 #define MSI_MAX VECTOR_MAX
 
-#define seL4_VCPUBits 14
+#define seL4_VCPUBits 15
 #define seL4_X86_VCPUBits    seL4_VCPUBits
 
 #define seL4_X86_EPTPML4EntryBits 3
@@ -49,4 +49,23 @@
 #define seL4_X86_EPTPTIndexBits   9
 #define seL4_X86_EPTPTBits   (seL4_X86_EPTPTEntryBits + seL4_X86_EPTPTIndexBits)
 
+/* Number of words in the bitmap returned by seL4_X86_EPTPML4_HarvestDirty */
+#define seL4_X86_EPTDirtyBitmapWords 16
+
+#if defined(CONFIG_X86_FAULT_REPLY_MAP) && !defined(__ASSEMBLER__)
+/* Format of a reply to a VM fault that maps the frame given as its first extra
+ * cap at the faulting address, rounded down to the size of the frame. The
+ * second extra cap must be the VSpace root of the faulting thread. If the
+ * frame cannot be mapped the thread is still restarted, and the VM fault it
+ * raises next has seL4_VMFaultReply_MapFailed set in its FSR */
+enum {
+    seL4_VMFaultReply_Rights,
+    seL4_VMFaultReply_Attributes,
+    seL4_VMFaultReply_Length,
+    SEL4_FORCE_LONG_ENUM(seL4_VMFaultReply_Msg),
+} seL4_VMFaultReply_Msg;
+
+#define seL4_VMFaultReply_MapFailed 0x80000000ul
+#endif
+
 #endif
@@ -46,4 +46,23 @@ typedef struct seL4_VCPUContext_ {
     seL4_Word eax, ebx, ecx, edx, esi, edi, ebp;
 } seL4_VCPUContext;
 
+/* Fields and values given to the batched VMCS invocations. The number of
+ * members must match SEL4_VMCS_BATCH_MAX_FIELDS */
+typedef struct seL4_VCPUVMCSFields_ {
+    seL4_Word field0, field1, field2, field3, field4, field5, field6, field7,
+              field8, field9, field10, field11, field12, field13, field14, field15;
+} seL4_VCPUVMCSFields;
+
+typedef struct seL4_VCPUVMCSValues_ {
+    seL4_Word value0, value1, value2, value3, value4, value5, value6, value7,
+              value8, value9, value10, value11, value12, value13, value14, value15;
+} seL4_VCPUVMCSValues;
+
+/* Dirty page bitmap returned by seL4_X86_EPTPML4_HarvestDirty. The number of
+ * members must match seL4_X86_EPTDirtyBitmapWords */
+typedef struct seL4_X86_EPTDirtyBitmap_ {
+    seL4_Word word0, word1, word2, word3, word4, word5, word6, word7,
+              word8, word9, word10, word11, word12, word13, word14, word15;
+} seL4_X86_EPTDirtyBitmap;
+
 #endif
@@ -43,6 +43,13 @@
 #define SEL4_VMENTER_FAULT_EDI 15
 #define SEL4_VMENTER_FAULT_EBP 16
 
+/*
+ * If the VCPU has been given an exit snapshot with seL4_X86_VCPU_SetExitSnapshot
+ * then the values of the requested VMCS fields follow the above registers, in
+ * the order they were given
+ */
+#define SEL4_VMENTER_FAULT_SNAPSHOT_START 17
+
 /*
  * After performing a seL4_SysVMEnter the msgInfo register is set to indicate
  * whether a return back to this thread happened due to a fault in the associated
@@ -67,4 +74,30 @@
 #define SEL4_VMENTER_RESULT_FAULT_LEN 17
 #define SEL4_VMENTER_RESULT_NOTIF_LEN 3
 
+/*
+ * Maximum number of VMCS fields that can be given to seL4_X86_VCPU_ReadVMCSBatch,
+ * seL4_X86_VCPU_WriteVMCSBatch and seL4_X86_VCPU_SetExitSnapshot. This is also
+ * the number of members of seL4_VCPUVMCSFields and seL4_VCPUVMCSValues
+ */
+#define SEL4_VMCS_BATCH_MAX_FIELDS 16
+
+/*
+ * A VCPU can be configured with an exit policy that allows the kernel to
+ * complete simple exits itself and resume the guest without returning from
+ * VMEnter. These constants describe the number of entries available for each
+ * exit type and the flags that can be given when configuring an entry.
+ *
+ * ENABLE marks the entry as valid. ANY_SUBLEAF causes a CPUID entry to match
+ * regardless of the subleaf in ECX. WRITABLE causes an MSR entry to also
+ * complete WRMSR exits by storing the written value, which is then returned
+ * by subsequent RDMSR exits.
+ */
+#define SEL4_VMEXIT_POLICY_NUM_CPUID 16
+#define SEL4_VMEXIT_POLICY_NUM_MSR 16
+#define SEL4_VMEXIT_POLICY_NUM_IOPORT 8
+
+#define SEL4_VMEXIT_POLICY_ENABLE 1
+#define SEL4_VMEXIT_POLICY_ANY_SUBLEAF 2
+#define SEL4_VMEXIT_POLICY_WRITABLE 4
+
 #endif /* __LIBSEL4_ARCH_VMENTER */
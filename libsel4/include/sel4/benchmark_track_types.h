@@ -55,6 +55,15 @@ typedef struct PACKED kernel_entry {
             seL4_Word is_fastpath: 1;
             seL4_Word invocation_tag: 19;
         };
+#ifdef CONFIG_ARCH_X86
+        /* Exit reason for Entry_VMExit, and whether the kernel completed
+         * the exit itself using the VCPU exit policy */
+        struct {
+            seL4_Word vmexit_reason: 16;
+            seL4_Word vmexit_in_kernel: 1;
+            seL4_Word vmexit_padding: 12;
+        };
+#endif
     };
 } kernel_entry_t;
 
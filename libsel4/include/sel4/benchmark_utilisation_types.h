@@ -22,7 +22,30 @@ enum benchmark_track_util_ipc_index {
     BENCHMARK_TCB_UTILISATION,
     BENCHMARK_IDLE_LOCALCPU_UTILISATION,
     BENCHMARK_IDLE_TCBCPU_UTILISATION,
-    BENCHMARK_TOTAL_UTILISATION
+    BENCHMARK_TOTAL_UTILISATION,
+#ifdef CONFIG_HAVE_FPU
+    /* Number of FPU faults taken by the thread, and the number of times
+     * its FPU state was restored eagerly on a switch to it */
+    BENCHMARK_TCB_FPU_FAULTS,
+    BENCHMARK_TCB_FPU_EAGER_RESTORES,
+#endif
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    /* Number of times the state of a different VCPU was loaded, and the
+     * total time spent saving and restoring VCPU state to do so */
+    BENCHMARK_VCPU_SWITCHES,
+    BENCHMARK_VCPU_SWITCH_TIME,
+#endif
+#ifdef CONFIG_X86_IDLE_MWAIT
+    /* Idle statistics of the CPU the TCB is running on: the number of idle
+     * periods, the cycles spent in them and how many used a C-state deeper
+     * than C1, followed by the number of idle periods ended by an IPI and the
+     * total cycles from sending the IPI until the CPU entered the kernel */
+    BENCHMARK_IDLE_TCBCPU_ENTRIES,
+    BENCHMARK_IDLE_TCBCPU_RESIDENCY,
+    BENCHMARK_IDLE_TCBCPU_DEEP_ENTRIES,
+    BENCHMARK_IDLE_TCBCPU_IPI_WAKEUPS,
+    BENCHMARK_IDLE_TCBCPU_WAKE_LATENCY,
+#endif
 };
 
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
@@ -59,7 +59,9 @@ typedef struct {
     seL4_IPCBuffer*   ipcBuffer;       /* pointer to initial thread's IPC buffer */
     seL4_SlotRegion   empty;           /* empty slots (null caps) */
     seL4_SlotRegion   sharedFrames;    /* shared-frame caps (shared between seL4 nodes) */
-    seL4_SlotRegion   userImageFrames; /* userland-image frame caps */
+    seL4_SlotRegion   userImageFrames; /* userland-image frame caps, in order of increasing virtual address. With
+                                        * CONFIG_ROOT_TASK_LARGE_PAGES some of them are large frames, so the
+                                        * virtual address of a frame is not its index times the page size */
     seL4_SlotRegion   userImagePaging; /* userland-image paging structure caps */
     seL4_SlotRegion   ioSpaceCaps;     /* IOSpace caps for ARM SMMU */
     seL4_SlotRegion   extraBIPages;    /* caps for any pages used to back the additional bootinfo information */
@@ -89,5 +91,62 @@ typedef struct {
 #define SEL4_BOOTINFO_HEADER_X86_ACPI_RSDP 3
 #define SEL4_BOOTINFO_HEADER_X86_FRAMEBUFFER 4
 #define SEL4_BOOTINFO_HEADER_X86_TSC_FREQ 5 // frequency is in mhz
+#define SEL4_BOOTINFO_HEADER_X86_NUMA 6
+#define SEL4_BOOTINFO_HEADER_BOOT_PROFILE 7
+#define SEL4_BOOTINFO_HEADER_X86_TOPOLOGY 8
+#define SEL4_BOOTINFO_HEADER_KERNEL_INFO 9
+
+/* Phases of kernel initialisation that are timestamped when the kernel is built
+ * with boot profiling, in the order in which they complete */
+typedef enum {
+    seL4_BootPhase_Entry,          /* entry into the kernel's C code */
+    seL4_BootPhase_Platform,       /* firmware tables parsed and boot modules loaded */
+    seL4_BootPhase_CPU,            /* CPU and interrupt controller initialised */
+    seL4_BootPhase_FreeMemory,     /* free memory regions set up for allocation */
+    seL4_BootPhase_RootVSpace,     /* initial thread's address space and frames created */
+    seL4_BootPhase_IOMMU,          /* IOMMU page tables and contexts created */
+    seL4_BootPhase_Untypeds,       /* untyped caps created, including zeroing */
+    seL4_BootPhase_SecondaryCores, /* all other cores have finished booting */
+    seL4_BootPhase_Exit,           /* about to enter the initial thread */
+    seL4_NumBootPhases
+} seL4_BootPhase;
+
+/* Timestamps of the end of each seL4_BootPhase, using the kernel's timestamp
+ * source, for each of the numNodes cores that booted. Phases that a core does
+ * not go through, or that are not implemented on a platform, are 0 */
+typedef struct {
+    seL4_BootInfoHeader header;
+    seL4_Word numNodes;
+    seL4_Uint64 timestamps[][seL4_NumBootPhases];
+} SEL4_PACKED seL4_BootInfo_Profile_t;
+
+/* Information about each core that the kernel keeps up to date in a frame
+ * that user level can only map read-only. The kernel is writing to a record
+ * while its seq is odd, so readers retry until they see the same even seq
+ * before and after reading the other fields. Timestamps are in units of the
+ * kernel's timestamp counter, the TSC on x86, which user level reads directly */
+typedef struct {
+    seL4_Word   seq;
+    seL4_Word   domain;      /* current scheduling domain */
+    seL4_Word   domainTime;  /* timer ticks left in the current domain */
+    seL4_Word   runnable;    /* runnable threads, including the one running */
+    seL4_Uint64 idleTime;    /* timestamps spent in the idle thread */
+    seL4_Uint64 idleEntries; /* number of times the core became idle */
+    seL4_Uint8  padding[64 - 4 * sizeof(seL4_Word) - 2 * sizeof(seL4_Uint64)];
+} SEL4_PACKED seL4_KernelInfoNode;
+
+typedef struct {
+    seL4_Word   numNodes;      /* number of valid entries in nodes */
+    seL4_Word   timestampFreq; /* timestamp counter frequency in MHz */
+    seL4_Uint8  padding[64 - 2 * sizeof(seL4_Word)];
+    seL4_KernelInfoNode nodes[CONFIG_MAX_NUM_NODES];
+} SEL4_PACKED seL4_KernelInfo;
+
+/* Slot of the read-only frame cap of the seL4_KernelInfo, when the kernel is
+ * built with KernelInfoPage */
+typedef struct {
+    seL4_BootInfoHeader header;
+    seL4_SlotPos frame;
+} SEL4_PACKED seL4_BootInfo_KernelInfo_t;
 
 #endif // __LIBSEL4_BOOTINFO_TYPES_H
@@ -99,6 +99,15 @@ enum {
     seL4_VCPUReg_Num,
 } seL4_VCPUReg;
 
+/* Maximum number of registers given to seL4_ARM_VCPU_ReadRegsBatch and
+ * seL4_ARM_VCPU_WriteRegsBatch, and the number of members of
+ * seL4_VCPURegFields and seL4_VCPURegValues */
+#define seL4_VCPURegBatchMax 16
+
+/* Maximum number of virqs given to seL4_ARM_VCPU_InjectIRQs, and the number
+ * of members of seL4_VCPUVirqs and seL4_VCPUVirqIndices */
+#define seL4_VCPUInjectIRQsMax 8
+
 #endif /* CONFIG_ARM_HYPERVISOR_SUPPORT */
 #endif /* !__ASSEMBLER__ */
 
@@ -28,4 +28,29 @@ typedef struct seL4_UserContext_ {
     seL4_Word r2, r3, r4, r5, r6, r7, r14;
 } seL4_UserContext;
 
+/* Registers and values given to the batched VCPU register invocations. The
+ * number of members must match seL4_VCPURegBatchMax */
+typedef struct seL4_VCPURegFields_ {
+    seL4_Word field0, field1, field2, field3, field4, field5, field6, field7,
+              field8, field9, field10, field11, field12, field13, field14, field15;
+} seL4_VCPURegFields;
+
+typedef struct seL4_VCPURegValues_ {
+    seL4_Word value0, value1, value2, value3, value4, value5, value6, value7,
+              value8, value9, value10, value11, value12, value13, value14, value15;
+} seL4_VCPURegValues;
+
+/* Virtual IRQs given to seL4_ARM_VCPU_InjectIRQs and the list registers they
+ * were placed in. Each virq is encoded as the first word of
+ * seL4_ARM_VCPU_InjectIRQ: the IRQ in bits 0-15, the priority in bits 16-23
+ * and the group in bits 24-31. The number of members must match
+ * seL4_VCPUInjectIRQsMax */
+typedef struct seL4_VCPUVirqs_ {
+    seL4_Word virq0, virq1, virq2, virq3, virq4, virq5, virq6, virq7;
+} seL4_VCPUVirqs;
+
+typedef struct seL4_VCPUVirqIndices_ {
+    seL4_Word index0, index1, index2, index3, index4, index5, index6, index7;
+} seL4_VCPUVirqIndices;
+
 #endif /* __LIBSEL4_SEL4_ARCH_TYPES_H */
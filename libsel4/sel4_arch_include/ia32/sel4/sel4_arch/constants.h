@@ -28,7 +28,10 @@
 
 #define seL4_PageBits        12 /* 4K */
 #define seL4_SlotBits         4
-#if CONFIG_XSAVE_SIZE > 576 || (CONFIG_XSAVE_SIZE == 576 && defined(CONFIG_DEBUG_BUILD))
+#if CONFIG_XSAVE_SIZE > 1536
+/* AVX-512 state needs a larger TCB again */
+#define seL4_TCBBits         12
+#elif CONFIG_XSAVE_SIZE > 576 || (CONFIG_XSAVE_SIZE == 576 && defined(CONFIG_DEBUG_BUILD))
 /* If we have a larger XSAVE then we're storing AVX state
  * and will need a larger total TCB size */
 #define seL4_TCBBits         11
@@ -257,6 +257,10 @@ def init_arch_types(wordsize):
             CapType("seL4_ARM_IOSpace", wordsize),
             CapType("seL4_ARM_IOPageTable", wordsize),
             StructType("seL4_UserContext", wordsize * 17, wordsize),
+            StructType("seL4_VCPURegFields", wordsize * 16, wordsize),
+            StructType("seL4_VCPURegValues", wordsize * 16, wordsize),
+            StructType("seL4_VCPUVirqs", wordsize * 8, wordsize),
+            StructType("seL4_VCPUVirqIndices", wordsize * 8, wordsize),
         ],
 
         "aarch64" : [
@@ -302,6 +306,9 @@ def init_arch_types(wordsize):
             CapType("seL4_X86_EPTPD", wordsize),
             CapType("seL4_X86_EPTPT", wordsize),
             StructType("seL4_VCPUContext", wordsize * 7 ,wordsize),
+            StructType("seL4_VCPUVMCSFields", wordsize * 16, wordsize),
+            StructType("seL4_VCPUVMCSValues", wordsize * 16, wordsize),
+            StructType("seL4_X86_EPTDirtyBitmap", wordsize * 16, wordsize),
             StructType("seL4_UserContext", wordsize * 13, wordsize),
         ],
 
@@ -323,6 +330,9 @@ def init_arch_types(wordsize):
             CapType("seL4_X86_EPTPD", wordsize),
             CapType("seL4_X86_EPTPT", wordsize),
             StructType("seL4_VCPUContext", wordsize * 7 ,wordsize),
+            StructType("seL4_VCPUVMCSFields", wordsize * 16, wordsize),
+            StructType("seL4_VCPUVMCSValues", wordsize * 16, wordsize),
+            StructType("seL4_X86_EPTDirtyBitmap", wordsize * 16, wordsize),
             StructType("seL4_UserContext", wordsize * 19, wordsize),
         ]
     }
@@ -27,6 +27,7 @@
 #include <string.h>
 #include <kernel/traps.h>
 #include <arch/machine.h>
+#include <linker.h>
 
 #ifdef CONFIG_DEBUG_BUILD
 #include <arch/machine/capdl.h>
@@ -35,7 +36,7 @@
 /* The haskell function 'handleEvent' is split into 'handleXXX' variants
  * for each event causing a kernel entry */
 
-exception_t
+HOT_CODE exception_t
 handleInterruptEntry(void)
 {
     irq_t irq;
@@ -177,6 +178,10 @@ handleUnknownSyscall(word_t w)
         NODE_STATE(ksCurThread)->benchmark.schedule_start_time = ksEnter;
         benchmark_start_time = ksEnter;
         benchmark_arch_utilisation_reset();
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+        benchmark_vcpu_switches = 0;
+        benchmark_vcpu_switch_time = 0;
+#endif /* CONFIG_ARM_HYPERVISOR_SUPPORT */
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
         setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
         return EXCEPTION_NONE;
@@ -219,6 +224,10 @@ handleUnknownSyscall(word_t w)
 #endif /* CONFIG_ENABLE_BENCHMARKS */
 
     current_fault = seL4_Fault_UnknownSyscall_new(w);
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    /* does not return if the fault was delivered */
+    fastpath_fault();
+#endif
     handleFault(NODE_STATE(ksCurThread));
 
     schedule();
@@ -231,6 +240,10 @@ exception_t
 handleUserLevelFault(word_t w_a, word_t w_b)
 {
     current_fault = seL4_Fault_UserException_new(w_a, w_b);
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    /* does not return if the fault was delivered */
+    fastpath_fault();
+#endif
     handleFault(NODE_STATE(ksCurThread));
 
     schedule();
@@ -246,6 +259,10 @@ handleVMFaultEvent(vm_fault_type_t vm_faultType)
 
     status = handleVMFault(NODE_STATE(ksCurThread), vm_faultType);
     if (status != EXCEPTION_NONE) {
+#ifdef CONFIG_FASTPATH_VM_FAULT
+        /* does not return if the fault was delivered */
+        fastpath_fault();
+#endif
         handleFault(NODE_STATE(ksCurThread));
     }
 
@@ -256,7 +273,7 @@ handleVMFaultEvent(vm_fault_type_t vm_faultType)
 }
 
 
-static exception_t
+static HOT_CODE exception_t
 handleInvocation(bool_t isCall, bool_t isBlocking)
 {
     seL4_MessageInfo_t info;
@@ -330,7 +347,7 @@ handleInvocation(bool_t isCall, bool_t isBlocking)
     return EXCEPTION_NONE;
 }
 
-static void
+static HOT_CODE void
 handleReply(void)
 {
     cte_t *callerSlot;
@@ -365,7 +382,7 @@ handleReply(void)
     fail("handleReply: invalid caller cap");
 }
 
-static void
+static HOT_CODE void
 handleRecv(bool_t isBlocking)
 {
     word_t epCPtr;
@@ -427,7 +444,7 @@ handleYield(void)
     rescheduleRequired();
 }
 
-exception_t
+HOT_CODE exception_t
 handleSyscall(syscall_t syscall)
 {
     exception_t ret;
@@ -706,7 +706,7 @@ findPDForASID(asid_t asid)
     return ret;
 }
 
-word_t * PURE
+HOT_CODE word_t * PURE
 lookupIPCBuffer(bool_t isReceiver, tcb_t *thread)
 {
     word_t w_bufferPtr;
@@ -16,6 +16,7 @@
 #include <arch/machine/registerset.h>
 #include <api/syscall.h>
 #include <machine/fpu.h>
+#include <linker.h>
 
 #include <benchmark/benchmark_track_types.h>
 #include <benchmark/benchmark_track.h>
@@ -109,7 +110,7 @@ c_handle_interrupt(void)
     restore_user_context();
 }
 
-void NORETURN
+HOT_CODE void NORETURN
 slowpath(syscall_t syscall)
 {
 #ifdef TRACK_KERNEL_ENTRIES
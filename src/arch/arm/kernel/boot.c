@@ -460,7 +460,8 @@ try_init_kernel(
             it_pd_cap,
             ui_reg,
             true,
-            pv_offset
+            pv_offset,
+            false
         );
     if (!create_frames_ret.success) {
         return false;
@@ -16,6 +16,7 @@
 #include <plat/machine/devices.h>
 #include <arch/machine/debug.h> /* Arch_debug[A/Di]ssociateVCPUTCB() */
 #include <arch/machine/debug_conf.h>
+#include <benchmark/benchmark_utilisation.h>
 
 #define HCR_TGE      BIT(27)     /* Trap general exceptions        */
 #define HCR_TVM      BIT(26)     /* Trap MMU access                */
@@ -82,6 +83,9 @@
 #define VGIC_VTR_NPRIOBITS(vtr)         ((((vtr) >> 29) & 0x07) + 1)
 #define VGIC_VTR_NPREBITS(vtr)          ((((vtr) >> 26) & 0x07) + 1)
 
+/* Bit of a list register in the 64 bit ELRSR and EISR bitmaps */
+#define VGIC_LR_BIT(n)                  (1ull << (n))
+
 struct gich_vcpu_ctrl_map {
     uint32_t hcr;    /* 0x000 RW 0x00000000 Hypervisor Control Register */
     uint32_t vtr;    /* 0x004 RO IMPLEMENTATION DEFINED VGIC Type Register */
@@ -113,6 +117,12 @@ static volatile struct gich_vcpu_ctrl_map *gic_vcpu_ctrl =
 #endif /* GIC_PL400_GICVCPUCTRL_PPTR */
 
 static unsigned int gic_vcpu_num_list_regs;
+static uint64_t gic_vcpu_list_regs_mask;
+
+/* Bitmap of the hardware list registers that may hold a non empty entry.
+ * Only these need to be saved from, or cleared in, the hardware when the
+ * VCPU is switched */
+static uint64_t gic_vcpu_live_list_regs;
 
 static inline word_t
 get_lr_svc(void)
@@ -378,6 +388,18 @@ get_gic_vcpu_ctrl_eisr1(void)
     return gic_vcpu_ctrl->eisr1;
 }
 
+static inline uint32_t
+get_gic_vcpu_ctrl_elrsr0(void)
+{
+    return gic_vcpu_ctrl->elsr0;
+}
+
+static inline uint32_t
+get_gic_vcpu_ctrl_elrsr1(void)
+{
+    return gic_vcpu_ctrl->elsr1;
+}
+
 static inline uint32_t
 get_gic_vcpu_ctrl_misr(void)
 {
@@ -478,6 +500,13 @@ vcpu_boot_init(void)
         printf("Warning: VGIC is reporting more list registers than we support. Truncating\n");
         gic_vcpu_num_list_regs = GIC_VCPU_MAX_NUM_LR;
     }
+    if (gic_vcpu_num_list_regs == 64) {
+        gic_vcpu_list_regs_mask = ~0ull;
+    } else {
+        gic_vcpu_list_regs_mask = VGIC_LR_BIT(gic_vcpu_num_list_regs) - 1;
+    }
+    /* we do not know what the list registers contain out of reset */
+    gic_vcpu_live_list_regs = gic_vcpu_list_regs_mask;
     vcpu_disable(NULL);
     armHSCurVCPU = NULL;
     armHSVCPUActive = false;
@@ -508,6 +537,7 @@ vcpu_save(vcpu_t *vcpu, bool_t active)
 {
     word_t i;
     unsigned int lr_num;
+    uint64_t live;
 
     assert(vcpu);
     dsb();
@@ -523,10 +553,19 @@ vcpu_save(vcpu_t *vcpu, bool_t active)
     /* Store GIC VCPU control state */
     vcpu->vgic.vmcr = get_gic_vcpu_ctrl_vmcr();
     vcpu->vgic.apr = get_gic_vcpu_ctrl_apr();
+    /* Only read back the list registers that the VGIC reports as not empty,
+     * an empty list register is recorded as an invalid entry without
+     * touching the hardware */
     lr_num = gic_vcpu_num_list_regs;
+    live = ~(((uint64_t)get_gic_vcpu_ctrl_elrsr1() << 32) | get_gic_vcpu_ctrl_elrsr0()) & gic_vcpu_list_regs_mask;
     for (i = 0; i < lr_num; i++) {
-        vcpu->vgic.lr[i] = get_gic_vcpu_ctrl_lr(i);
+        if (live & VGIC_LR_BIT(i)) {
+            vcpu->vgic.lr[i] = get_gic_vcpu_ctrl_lr(i);
+        } else {
+            vcpu->vgic.lr[i] = virq_virq_invalid_new(0);
+        }
     }
+    gic_vcpu_live_list_regs = live;
 
     /* save banked registers */
     vcpu->lr_svc = get_lr_svc();
@@ -763,6 +802,7 @@ vcpu_restore(vcpu_t *vcpu)
     assert(vcpu);
     word_t i;
     unsigned int lr_num;
+    uint64_t live;
     /* Turn off the VGIC */
     set_gic_vcpu_ctrl_hcr(0);
     isb();
@@ -770,10 +810,19 @@ vcpu_restore(vcpu_t *vcpu)
     /* Restore GIC VCPU control state */
     set_gic_vcpu_ctrl_vmcr(vcpu->vgic.vmcr);
     set_gic_vcpu_ctrl_apr(vcpu->vgic.apr);
+    /* Only write the list registers that are in use by this VCPU, or that
+     * still hold an entry of the previous VCPU and need clearing */
     lr_num = gic_vcpu_num_list_regs;
+    live = 0;
     for (i = 0; i < lr_num; i++) {
-        set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
+        if (vcpu->vgic.lr[i].words[0] != 0) {
+            live |= VGIC_LR_BIT(i);
+            set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
+        } else if (gic_vcpu_live_list_regs & VGIC_LR_BIT(i)) {
+            set_gic_vcpu_ctrl_lr(i, vcpu->vgic.lr[i]);
+        }
     }
+    gic_vcpu_live_list_regs = live;
 
     /* restore banked registers */
     set_lr_svc(vcpu->lr_svc);
@@ -870,12 +919,21 @@ vcpu_switch(vcpu_t *new)
 {
     if (likely(armHSCurVCPU != new)) {
         if (unlikely(new != NULL)) {
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+            timestamp_t start = timestamp();
+#endif
+            /* The state of the previous VCPU, including its banked registers,
+             * stays loaded whilst native threads run and is only saved here,
+             * once a different VCPU needs the core */
             if (unlikely(armHSCurVCPU != NULL)) {
                 vcpu_save(armHSCurVCPU, armHSVCPUActive);
             }
             vcpu_restore(new);
             armHSCurVCPU = new;
             armHSVCPUActive = true;
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+            benchmark_utilisation_vcpu_switch(start);
+#endif
         } else if (unlikely(armHSVCPUActive)) {
             /* leave the current VCPU state loaded, but disable vgic and mmu */
 #ifdef ARM_HYP_CP14_SAVE_AND_RESTORE_VCPU_THREADS
@@ -1015,6 +1073,7 @@ invokeVCPUInjectIRQ(vcpu_t* vcpu, unsigned long index, virq_t virq)
 {
     if (likely(armHSCurVCPU == vcpu)) {
         set_gic_vcpu_ctrl_lr(index, virq);
+        gic_vcpu_live_list_regs |= VGIC_LR_BIT(index);
     } else {
         vcpu->vgic.lr[index] = virq;
     }
@@ -1089,6 +1148,226 @@ decodeVCPUInjectIRQ(cap_t cap, unsigned int length, word_t* buffer)
     return invokeVCPUInjectIRQ(vcpu, index, virq);
 }
 
+static exception_t
+decodeVCPURegBatchCount(word_t count)
+{
+    if (count > seL4_VCPURegBatchMax) {
+        userError("VCPU: Invalid number of registers %ld.", (long)count);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = seL4_VCPURegBatchMax;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    return EXCEPTION_NONE;
+}
+
+exception_t
+invokeVCPUReadRegsBatch(vcpu_t *vcpu, word_t count, uint32_t *fields, bool_t call)
+{
+    tcb_t *thread;
+    word_t i;
+    thread = ksCurThread;
+    if (call) {
+        word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+        unsigned int length = 0;
+        setRegister(thread, badgeRegister, 0);
+        for (i = 0; i < count; i++) {
+            length = setMR(thread, ipcBuffer, i, readVCPUReg(vcpu, fields[i]));
+        }
+        setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                        seL4_MessageInfo_new(0, 0, 0, length)));
+    }
+    setThreadState(ksCurThread, ThreadState_Running);
+    return EXCEPTION_NONE;
+}
+
+exception_t
+decodeVCPUReadRegsBatch(cap_t cap, unsigned int length, bool_t call, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    uint32_t fields[seL4_VCPURegBatchMax];
+    exception_t status;
+
+    if (length < 1 + seL4_VCPURegBatchMax) {
+        userError("VCPUReadRegsBatch: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    status = decodeVCPURegBatchCount(count);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    /* the fields are copied out as the reply overwrites the same message
+     * registers */
+    for (i = 0; i < count; i++) {
+        fields[i] = getSyscallArg(i + 1, buffer);
+        if (fields[i] >= seL4_VCPUReg_Num) {
+            userError("VCPUReadRegsBatch: Invalid field 0x%lx.", (long)fields[i]);
+            current_syscall_error.type = seL4_InvalidArgument;
+            current_syscall_error.invalidArgumentNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(ksCurThread, ThreadState_Restart);
+    return invokeVCPUReadRegsBatch(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, fields, call);
+}
+
+exception_t
+invokeVCPUWriteRegsBatch(vcpu_t *vcpu, word_t count, uint32_t *fields, uint32_t *values)
+{
+    word_t i;
+    for (i = 0; i < count; i++) {
+        writeVCPUReg(vcpu, fields[i], values[i]);
+    }
+    return EXCEPTION_NONE;
+}
+
+exception_t
+decodeVCPUWriteRegsBatch(cap_t cap, unsigned int length, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    uint32_t fields[seL4_VCPURegBatchMax];
+    uint32_t values[seL4_VCPURegBatchMax];
+    exception_t status;
+
+    if (length < 1 + seL4_VCPURegBatchMax * 2) {
+        userError("VCPUWriteRegsBatch: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    status = decodeVCPURegBatchCount(count);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        fields[i] = getSyscallArg(i + 1, buffer);
+        values[i] = getSyscallArg(i + 1 + seL4_VCPURegBatchMax, buffer);
+        if (fields[i] >= seL4_VCPUReg_Num) {
+            userError("VCPUWriteRegsBatch: Invalid field 0x%lx.", (long)fields[i]);
+            current_syscall_error.type = seL4_InvalidArgument;
+            current_syscall_error.invalidArgumentNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(ksCurThread, ThreadState_Restart);
+    return invokeVCPUWriteRegsBatch(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, fields, values);
+}
+
+/* A list register is free if it holds no interrupt and has no EOI maintenance
+ * outstanding, which is exactly what the hardware reports in ELRSR */
+static uint64_t
+vcpu_free_list_regs(vcpu_t *vcpu)
+{
+    word_t i;
+    uint64_t free;
+
+    if (likely(armHSCurVCPU == vcpu)) {
+        return (((uint64_t)get_gic_vcpu_ctrl_elrsr1() << 32) | get_gic_vcpu_ctrl_elrsr0()) & gic_vcpu_list_regs_mask;
+    }
+
+    free = 0;
+    for (i = 0; i < gic_vcpu_num_list_regs; i++) {
+        virq_t virq = vcpu->vgic.lr[i];
+        if (virq_get_virqType(virq) == virq_virq_invalid && !virq_virq_invalid_get_virqEOIIRQEN(virq)) {
+            free |= VGIC_LR_BIT(i);
+        }
+    }
+    return free;
+}
+
+exception_t
+invokeVCPUInjectIRQs(vcpu_t *vcpu, word_t count, virq_t *virqs, bool_t call)
+{
+    tcb_t *thread;
+    uint64_t free;
+    word_t indices[seL4_VCPUInjectIRQsMax];
+    word_t injected;
+    word_t index;
+    word_t i;
+
+    thread = ksCurThread;
+    free = vcpu_free_list_regs(vcpu);
+    index = 0;
+    for (injected = 0; injected < count; injected++) {
+        while (index < gic_vcpu_num_list_regs && !(free & VGIC_LR_BIT(index))) {
+            index++;
+        }
+        if (index == gic_vcpu_num_list_regs) {
+            break;
+        }
+        invokeVCPUInjectIRQ(vcpu, index, virqs[injected]);
+        indices[injected] = index;
+        index++;
+    }
+
+    if (call) {
+        word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+        unsigned int length;
+        setRegister(thread, badgeRegister, 0);
+        length = setMR(thread, ipcBuffer, 0, injected);
+        for (i = 0; i < seL4_VCPUInjectIRQsMax; i++) {
+            length = setMR(thread, ipcBuffer, i + 1, i < injected ? indices[i] : 0);
+        }
+        setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                        seL4_MessageInfo_new(0, 0, 0, length)));
+    }
+    setThreadState(ksCurThread, ThreadState_Running);
+    return EXCEPTION_NONE;
+}
+
+exception_t
+decodeVCPUInjectIRQs(cap_t cap, unsigned int length, bool_t call, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    virq_t virqs[seL4_VCPUInjectIRQsMax];
+
+    if (length < 1 + seL4_VCPUInjectIRQsMax) {
+        userError("VCPUInjectIRQs: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    if (count > seL4_VCPUInjectIRQsMax) {
+        userError("VCPUInjectIRQs: Invalid number of virqs %ld.", (long)count);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = seL4_VCPUInjectIRQsMax;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* Check every virq before injecting any, with the same limits as
+     * InjectIRQ */
+    for (i = 0; i < count; i++) {
+        word_t mr = getSyscallArg(i + 1, buffer);
+        word_t vid = mr & 0xffff;
+        word_t priority = (mr >> 16) & 0xff;
+        word_t group = (mr >> 24) & 0xff;
+
+        if (vid > (1U << 10) - 1 || priority > 31 || group > 1) {
+            userError("VCPUInjectIRQs: Invalid virq 0x%lx.", (long)mr);
+            current_syscall_error.type = seL4_InvalidArgument;
+            current_syscall_error.invalidArgumentNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        virqs[i] = virq_virq_pending_new(group, priority, 1, vid);
+    }
+
+    setThreadState(ksCurThread, ThreadState_Restart);
+    return invokeVCPUInjectIRQs(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, virqs, call);
+}
+
 exception_t decodeARMVCPUInvocation(
     word_t label,
     unsigned int length,
@@ -1109,6 +1388,12 @@ exception_t decodeARMVCPUInvocation(
         return decodeVCPUWriteReg(cap, length, buffer);
     case ARMVCPUInjectIRQ:
         return decodeVCPUInjectIRQ(cap, length, buffer);
+    case ARMVCPUReadRegsBatch:
+        return decodeVCPUReadRegsBatch(cap, length, call, buffer);
+    case ARMVCPUWriteRegsBatch:
+        return decodeVCPUWriteRegsBatch(cap, length, buffer);
+    case ARMVCPUInjectIRQs:
+        return decodeVCPUInjectIRQs(cap, length, call, buffer);
     default:
         userError("VCPU: Illegal operation.");
         current_syscall_error.type = seL4_IllegalOperation;
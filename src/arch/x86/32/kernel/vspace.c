@@ -439,7 +439,7 @@ create_it_page_directory_cap(cap_t vspace_cap, pptr_t pptr, vptr_t vptr, asid_t
 /* Create an address space for the initial thread.
  * This includes page directory and page tables */
 BOOT_CODE cap_t
-create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg)
+create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg, v_region_t large_v_reg)
 {
     cap_t      vspace_cap;
     vptr_t     vptr;
@@ -461,11 +461,15 @@ create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg)
     write_slot(SLOT_PTR(pptr_of_cap(root_cnode_cap), seL4_CapInitThreadVSpace), pd_cap);
     vspace_cap = pd_cap;
 
-    /* create all PT objs and caps necessary to cover userland image */
+    /* create all PT objs and caps necessary to cover userland image, except
+     * where it will be mapped with large frames */
 
     for (vptr = ROUND_DOWN(it_v_reg.start, PT_INDEX_BITS + PAGE_BITS);
             vptr < it_v_reg.end;
             vptr += BIT(PT_INDEX_BITS + PAGE_BITS)) {
+        if (vptr >= large_v_reg.start && vptr < large_v_reg.end) {
+            continue;
+        }
         pptr = alloc_region(seL4_PageTableBits);
         if (!pptr) {
             return cap_null_cap_new();
@@ -675,7 +679,7 @@ void modeUnmapPage(vm_page_size_t page_size, vspace_root_t *vroot, vptr_t vaddr,
 
 }
 
-exception_t decodeX86ModeMapRemapPage(word_t invLabel, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vaddr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr)
+exception_t decodeX86ModeMapRemapPage(word_t invLabel, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vaddr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr, bool_t restartCaller)
 {
     fail("Invalid Page type");
 }
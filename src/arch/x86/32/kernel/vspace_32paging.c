@@ -143,6 +143,23 @@ map_it_frame_cap(cap_t pd_cap, cap_t frame_cap)
 
     assert(cap_frame_cap_get_capFMappedASID(frame_cap) != 0);
     pd += (vptr >> seL4_LargePageBits);
+    if (cap_frame_cap_get_capFSize(frame_cap) == X86_LargePage) {
+        *pd = pde_pde_large_new(
+                  pptr_to_paddr(frame), /* page_base_address */
+                  0,                    /* pat               */
+                  0,                    /* avl               */
+                  0,                    /* global            */
+                  0,                    /* dirty             */
+                  0,                    /* accessed          */
+                  0,                    /* cache_disabled    */
+                  0,                    /* write_through     */
+                  1,                    /* super_user        */
+                  1,                    /* read_write        */
+                  1                     /* present           */
+              );
+        invalidateLocalPageStructureCache();
+        return;
+    }
     pt = paddr_to_pptr(pde_pde_pt_ptr_get_pt_base_address(pd));
     *(pt + ((vptr & MASK(seL4_LargePageBits)) >> seL4_PageBits)) = pte_new(
                                                                        pptr_to_paddr(frame), /* page_base_address */
@@ -210,7 +227,10 @@ exception_t performASIDPoolInvocation(asid_t asid, asid_pool_t* poolPtr, cte_t*
     if (cap_get_capType(vspaceCapSlot->cap) == cap_ept_pml4_cap) {
         cap_ept_pml4_cap_ptr_set_capPML4MappedASID(&vspaceCapSlot->cap, asid);
         cap_ept_pml4_cap_ptr_set_capPML4IsMapped(&vspaceCapSlot->cap, 1);
-        asid_map = asid_map_asid_map_ept_new(cap_ept_pml4_cap_get_capPML4BasePtr(vspaceCapSlot->cap));
+        asid_map = asid_map_asid_map_ept_new(
+                       cap_ept_pml4_cap_get_capPML4BasePtr(vspaceCapSlot->cap),
+                       0  /* accessed and dirty flags disabled */
+                   );
     } else
 #endif
     {
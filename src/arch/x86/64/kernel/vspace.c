@@ -551,6 +551,22 @@ map_it_frame_cap(cap_t pd_cap, cap_t frame_cap)
     assert(pdpte_pdpte_pd_ptr_get_present(pdpt));
     pd = paddr_to_pptr(pdpte_pdpte_pd_ptr_get_pd_base_address(pdpt));
     pd += GET_PD_INDEX(vptr);
+    if (cap_frame_cap_get_capFSize(frame_cap) == X86_LargePage) {
+        *pd = pde_pde_large_new(
+                  0,                      /* xd                   */
+                  pptr_to_paddr(pptr),    /* page_base_address    */
+                  0,                      /* pat                  */
+                  0,                      /* global               */
+                  0,                      /* dirty                */
+                  0,                      /* accessed             */
+                  0,                      /* cache_disabled       */
+                  0,                      /* write_through        */
+                  1,                      /* super_user           */
+                  1,                      /* read_write           */
+                  1                       /* present              */
+              );
+        return;
+    }
     assert(pde_pde_pt_ptr_get_present(pd));
     pt = paddr_to_pptr(pde_pde_pt_ptr_get_pt_base_address(pd));
     *(pt + GET_PT_INDEX(vptr)) = pte_new(
@@ -694,7 +710,7 @@ create_it_pt_cap(cap_t vspace_cap, pptr_t pptr, vptr_t vptr, asid_t asid)
 }
 
 BOOT_CODE cap_t
-create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg)
+create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg, v_region_t large_v_reg)
 {
     cap_t      vspace_cap;
     vptr_t     vptr;
@@ -751,10 +767,14 @@ create_it_address_space(cap_t root_cnode_cap, v_region_t it_v_reg)
         }
     }
 
-    /* Create any PTs needed for the user land image */
+    /* Create any PTs needed for the user land image, except where it will be
+     * mapped with large frames */
     for (vptr = ROUND_DOWN(it_v_reg.start, PD_INDEX_OFFSET);
             vptr < it_v_reg.end;
             vptr += BIT(PD_INDEX_OFFSET)) {
+        if (vptr >= large_v_reg.start && vptr < large_v_reg.end) {
+            continue;
+        }
         pptr = alloc_region(seL4_PageTableBits);
         if (!pptr) {
             return cap_null_cap_new();
@@ -837,7 +857,10 @@ performASIDPoolInvocation(asid_t asid, asid_pool_t *poolPtr, cte_t *vspaceCapSlo
     if (cap_get_capType(vspaceCapSlot->cap) == cap_ept_pml4_cap) {
         cap_ept_pml4_cap_ptr_set_capPML4MappedASID(&vspaceCapSlot->cap, asid);
         cap_ept_pml4_cap_ptr_set_capPML4IsMapped(&vspaceCapSlot->cap, 1);
-        asid_map = asid_map_asid_map_ept_new(cap_ept_pml4_cap_get_capPML4BasePtr(vspaceCapSlot->cap));
+        asid_map = asid_map_asid_map_ept_new(
+                       cap_ept_pml4_cap_get_capPML4BasePtr(vspaceCapSlot->cap),
+                       0  /* accessed and dirty flags disabled */
+                   );
     } else
 #endif
     {
@@ -1489,7 +1512,7 @@ performX64ModeMapRemapPage(cap_t cap, cte_t *ctSlot, pdpte_t pdpte, pdpte_t *pdp
 
 
 exception_t
-decodeX86ModeMapRemapPage(word_t label, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vaddr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr)
+decodeX86ModeMapRemapPage(word_t label, vm_page_size_t page_size, cte_t *cte, cap_t cap, vspace_root_t *vroot, vptr_t vaddr, paddr_t paddr, vm_rights_t vm_rights, vm_attributes_t vm_attr, bool_t restartCaller)
 {
     if (config_set(CONFIG_HUGE_PAGE) && page_size == X64_HugePage) {
         pdpte_t pdpte;
@@ -1521,7 +1544,9 @@ decodeX86ModeMapRemapPage(word_t label, vm_page_size_t page_size, cte_t *cte, ca
             }
 
             pdpte = makeUserPDPTEHugePage(paddr, vm_attr, vm_rights);
-            setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+            if (restartCaller) {
+                setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+            }
             return performX64ModeMapRemapPage(cap, cte, pdpte, pdptSlot, vroot);
         }
 
@@ -1534,7 +1559,9 @@ decodeX86ModeMapRemapPage(word_t label, vm_page_size_t page_size, cte_t *cte, ca
             }
 
             pdpte = makeUserPDPTEHugePage(paddr, vm_attr, vm_rights);
-            setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+            if (restartCaller) {
+                setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+            }
             return performX64ModeMapRemapPage(cap, cte, pdpte, pdptSlot, vroot);
         }
 
@@ -20,6 +20,9 @@ bool_t Arch_handleFaultReply(tcb_t *receiver, tcb_t *sender, word_t faultType)
 {
     switch (faultType) {
     case seL4_Fault_VMFault:
+#ifdef CONFIG_X86_FAULT_REPLY_MAP
+        handleVMFaultReplyMap(receiver, sender);
+#endif
         return true;
 
     default:
@@ -37,6 +40,13 @@ Arch_setMRs_fault(tcb_t *sender, tcb_t* receiver, word_t *receiveIPCBuffer, word
               seL4_Fault_VMFault_get_address(sender->tcbFault));
         setMR(receiver, receiveIPCBuffer, seL4_VMFault_PrefetchFault,
               seL4_Fault_VMFault_get_instructionFault(sender->tcbFault));
+#ifdef CONFIG_X86_FAULT_REPLY_MAP
+        if (sender->tcbArch.tcbVMFaultReplyMapFailed) {
+            sender->tcbArch.tcbVMFaultReplyMapFailed = false;
+            return setMR(receiver, receiveIPCBuffer, seL4_VMFault_FSR,
+                         seL4_Fault_VMFault_get_FSR(sender->tcbFault) | seL4_VMFaultReply_MapFailed);
+        }
+#endif
         return setMR(receiver, receiveIPCBuffer, seL4_VMFault_FSR,
                      seL4_Fault_VMFault_get_FSR(sender->tcbFault));
     }
@@ -17,6 +17,7 @@
 #include <arch/object/vcpu.h>
 #include <api/syscall.h>
 #include <arch/api/vmenter.h>
+#include <linker.h>
 
 #include <benchmark/benchmark_track.h>
 #include <benchmark/benchmark_utilisation.h>
@@ -31,7 +32,7 @@ c_nested_interrupt(int irq)
     ARCH_NODE_STATE(x86KSPendingInterrupt) = irq;
 }
 
-void VISIBLE NORETURN
+HOT_CODE void VISIBLE NORETURN
 c_handle_interrupt(int irq, int syscall)
 {
     /* need to run this first as the NODE_LOCK code might end up as a function call
@@ -106,13 +107,26 @@ c_handle_interrupt(int irq, int syscall)
     UNREACHABLE();
 }
 
-void NORETURN
+HOT_CODE void NORETURN
 slowpath(syscall_t syscall)
 {
 
 #ifdef CONFIG_VTX
     if (syscall == SysVMEnter) {
         vcpu_update_state_sysvmenter(NODE_STATE(ksCurThread)->tcbArch.tcbVCPU);
+        if (NODE_STATE(ksCurThread)->tcbBoundNotification && notification_ptr_get_state(NODE_STATE(ksCurThread)->tcbBoundNotification) == NtfnState_Active) {
+            /* Post any pending badge bits that the VCPU has mapped to guest vectors,
+             * leaving only the remainder to be returned to the VCPU owner */
+            notification_t *ntfnPtr = NODE_STATE(ksCurThread)->tcbBoundNotification;
+            word_t badge = notification_ptr_get_ntfnMsgIdentifier(ntfnPtr);
+            word_t remaining = vcpu_post_notification(NODE_STATE(ksCurThread), badge);
+            if (remaining != badge) {
+                notification_ptr_set_ntfnMsgIdentifier(ntfnPtr, remaining);
+                if (remaining == 0) {
+                    notification_ptr_set_state(ntfnPtr, NtfnState_Idle);
+                }
+            }
+        }
         if (NODE_STATE(ksCurThread)->tcbBoundNotification && notification_ptr_get_state(NODE_STATE(ksCurThread)->tcbBoundNotification) == NtfnState_Active) {
             completeSignal(NODE_STATE(ksCurThread)->tcbBoundNotification, NODE_STATE(ksCurThread));
             setRegister(NODE_STATE(ksCurThread), msgInfoRegister, SEL4_VMENTER_RESULT_NOTIF);
@@ -144,7 +158,7 @@ slowpath(syscall_t syscall)
     UNREACHABLE();
 }
 
-void VISIBLE NORETURN
+HOT_CODE void VISIBLE NORETURN
 c_handle_syscall(word_t cptr, word_t msgInfo, syscall_t syscall)
 {
     /* need to run this first as the NODE_LOCK code might end up as a function call
@@ -149,6 +149,7 @@ config_choice(KernelXSave KERNEL_XSAVE "The XSAVE area supports multiple instruc
     "XSAVEOPT;KernelXSaveXSaveOpt;XSAVE_XSAVEOPT;KernelFPUXSave"
     "XSAVE;KernelXSaveXSave;XSAVE_XSAVE;KernelFPUXSave"
     "XSAVEC;KernelXSaveXSaveC;XSAVE_XSAVEC;KernelFPUXSave"
+    "XSAVES;KernelXSaveXSaveS;XSAVE_XSAVES;KernelFPUXSave"
 )
 config_string(KernelXSaveFeatureSet XSAVE_FEATURE_SET
     "XSAVE can save and restore the state for various features \
@@ -157,7 +158,11 @@ config_string(KernelXSaveFeatureSet XSAVE_FEATURE_SET
         0 - FPU \
         1 - SSE \
         2 - AVX \
-        FPU and SSE is guaranteed to exist if XSAVE exists."
+        5 - AVX-512 opmask \
+        6 - AVX-512 upper halves of ZMM0-15 \
+        7 - AVX-512 ZMM16-31 \
+        FPU and SSE is guaranteed to exist if XSAVE exists. Supervisor state components can only \
+        be requested when using XSAVES."
     DEFAULT 3
     DEPENDS "KernelFPUXSave" DEFAULT_DISABLED 0
     UNQUOTE
@@ -172,7 +177,9 @@ endif()
 config_string(KernelXSaveSize XSAVE_SIZE
     "The size of the XSAVE region. This is dependent upon the features in \
     XSAVE_FEATURE_SET that have been requested. Default is 576 for the FPU and SSE
-    state, unless XSAVE is not in use then it should be 512 for the legacy FXSAVE region."
+    state, unless XSAVE is not in use then it should be 512 for the legacy FXSAVE region. \
+    With AVX this is 832, and with AVX-512 (0xe7) it is 2688, or 2432 when using the \
+    compacted format of XSAVEC or XSAVES. The kernel checks the size at boot."
     DEFAULT ${default_xsave_size}
     DEPENDS "KernelArchX86" DEFAULT_DISABLED 0
     UNQUOTE
@@ -255,6 +262,16 @@ config_option(KernelExportPMCUser EXPORT_PMC_USER
     DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
 )
 
+config_option(KernelRootTaskLargePages ROOT_TASK_LARGE_PAGES
+    "Map the initial thread's image with large frames. The image is placed in physical \
+    memory so that it can be mapped with large frames wherever its virtual addresses are \
+    large-page aligned, and no page tables are created for those parts. The userImageFrames \
+    region of the bootinfo then contains a mix of large and small frame caps, in order of \
+    increasing virtual address, which the initial thread must take into account."
+    DEFAULT OFF
+    DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
+)
+
 config_option(KernelX86DangerousMSR KERNEL_X86_DANGEROUS_MSR
     "rdmsr/wrmsr kernel interface. Provides a syscall interface for reading and writing arbitrary MSRs.
     This is extremely dangerous as no checks are performed and exists
@@ -312,6 +329,43 @@ config_option(KernelX86RSBOnContextSwitch KERNEL_X86_RSB_ON_CONTEXT_SWITCH
     DEPENDS "KernelArchX86"
 )
 
+config_option(KernelX86IdleMwait X86_IDLE_MWAIT
+    "Idle with MWAIT instead of HLT, using a governor that selects the C-state. Each time \
+    a core becomes idle the governor predicts the idle period from the time until the next \
+    timer tick and a moving average of previous idle periods, and picks the deepest C-state \
+    enumerated by CPUID whose target residency fits. Falls back to HLT if the processor \
+    does not support MONITOR/MWAIT. With utilisation tracking the idle residency and the \
+    wakeup latency of each core are reported with the thread utilisation."
+    DEFAULT OFF
+    DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
+)
+
+config_string(KernelX86IdleMwaitMaxCState X86_IDLE_MWAIT_MAX_CSTATE
+    "Deepest MWAIT C-state the idle governor may select, between 1 and 7."
+    DEFAULT 7
+    DEPENDS "KernelX86IdleMwait" UNDEF_DISABLED
+    UNQUOTE
+)
+
+config_string(KernelX86IdleMwaitTargetResidency X86_IDLE_MWAIT_TARGET_RESIDENCY
+    "Predicted idle period in microseconds required before the idle governor selects the \
+    shallowest C-state deeper than C1. The target residency doubles for each deeper state."
+    DEFAULT 20
+    DEPENDS "KernelX86IdleMwait" UNDEF_DISABLED
+    UNQUOTE
+)
+
+config_option(KernelX86FaultReplyMap X86_FAULT_REPLY_MAP
+    "Allow the reply to a VM fault to carry a frame cap that the kernel maps at the faulting \
+    address before restarting the thread, so a pager resolves a fault in a single ReplyRecv \
+    instead of a page map invocation followed by the reply. The frame is mapped into the \
+    VSpace of the faulting thread, whose root cap is passed as the second extra cap, with the \
+    rights and attributes given in the message. A failed mapping is flagged in the next VM \
+    fault of the thread."
+    DEFAULT OFF
+    DEPENDS "KernelArchX86;NOT KernelVerificationBuild"
+)
+
 add_sources(
     DEP "KernelArchX86"
     PREFIX src/arch/x86
@@ -335,6 +389,7 @@ add_sources(
         kernel/cmdline.c
         kernel/ept.c
         kernel/thread.c
+        kernel/kernelinfo.c
         model/statedata.c
         machine/hardware.c
         machine/fpu.c
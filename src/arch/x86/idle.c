@@ -12,14 +12,51 @@
 
 #include <config.h>
 #include <api/debug.h>
+#ifdef CONFIG_X86_IDLE_MWAIT
+#include <model/statedata.h>
+#include <machine/registerset.h>
+#include <arch/machine.h>
+#include <arch/kernel/apic.h>
+#include <arch/kernel/idle.h>
+#endif
 
-void idle_thread(void)
+static inline void NORETURN
+idle_hlt(void)
 {
     while (1) {
         asm volatile("hlt");
     }
 }
 
+void idle_thread(void)
+{
+#ifdef CONFIG_X86_IDLE_MWAIT
+    if (x86KSidleNumStates != 0) {
+        word_t monitor;
+        /* The first idle period uses C1. The hint is then reloaded from
+         * idleHintRegister on every iteration, as the governor updates it in
+         * our saved context before resuming us */
+        word_t hint = 0;
+
+        asm volatile(
+            "1:                         \n"
+            "mov %[line], %[monitor]    \n"
+            "xor %%ecx, %%ecx           \n"
+            "xor %%edx, %%edx           \n"
+            "monitor                    \n"
+            "mov %%esi, %%eax           \n"
+            "mwait                      \n"
+            "jmp 1b                     \n"
+            : [monitor] "=&a"(monitor)
+            : [line] "i"(&x86KSidleMonitorLine), "S"(hint)
+            : "ecx", "edx", "memory"
+        );
+        UNREACHABLE();
+    }
+#endif
+    idle_hlt();
+}
+
 /** DONT_TRANSLATE */
 void VISIBLE halt(void)
 {
@@ -32,6 +69,137 @@ void VISIBLE halt(void)
     debug_printKernelEntryReason();
 #endif
 #endif
-    idle_thread();
+    idle_hlt();
     UNREACHABLE();
 }
+
+#ifdef CONFIG_X86_IDLE_MWAIT
+BOOT_CODE void
+x86_idle_init(uint32_t tsc_mhz)
+{
+    uint32_t substates;
+    uint64_t target_residency;
+    word_t max_cstate = CONFIG_X86_IDLE_MWAIT_MAX_CSTATE;
+
+    x86KSidleNumStates = 0;
+    if (!(x86_cpuid_ecx(1, 0) & BIT(3))) {
+        printf("MONITOR/MWAIT not supported, idling with HLT\n");
+        return;
+    }
+
+    x86KSidleTscPerApicTick = tsc_mhz * 1000u / apic_get_timer_khz();
+
+    /* C1 is always available once MWAIT is */
+    x86KSidleStates[0] = (x86_idle_state_t) {
+        .hint = 0, .target_residency = 0
+    };
+    x86KSidleNumStates = 1;
+
+    /* Without the enumeration extension we do not know which deeper states exist */
+    if (x86_cpuid_eax(0, 0) < 5 || !(x86_cpuid_ecx(5, 0) & BIT(0))) {
+        return;
+    }
+
+    /* Without an always running APIC timer (ARAT) the timer stops in C3 and
+     * deeper states, and the kernel tick and any timeouts would be lost */
+    if (x86_cpuid_eax(0, 0) < 6 || !(x86_cpuid_eax(6, 0) & BIT(2))) {
+        if (max_cstate > 2) {
+            printf("APIC timer stops in deep C-states, idling with at most C2\n");
+            max_cstate = 2;
+        }
+    }
+
+    /* EDX holds the number of sub-states of each C-state, four bits per state
+     * starting with C0. Only sub-state 0 of each C-state is used */
+    substates = x86_cpuid_edx(5, 0);
+    target_residency = (uint64_t)CONFIG_X86_IDLE_MWAIT_TARGET_RESIDENCY * tsc_mhz;
+    for (word_t cstate = 2; cstate <= max_cstate; cstate++) {
+        if ((substates >> (cstate * 4)) & MASK(4)) {
+            x86KSidleStates[x86KSidleNumStates] = (x86_idle_state_t) {
+                .hint = (cstate - 1) << 4, .target_residency = target_residency
+            };
+            x86KSidleNumStates++;
+            target_residency <<= 1;
+        }
+    }
+}
+
+/* Called on every return to the idle thread to select the C-state for the coming
+ * idle period. The idle period cannot extend past the next timer tick, otherwise
+ * we expect it to be as long as recent ones */
+void
+x86_idle_enter(void)
+{
+    uint64_t predicted = ARCH_NODE_STATE(x86KSidlePredicted);
+    uint64_t next_tick;
+    word_t state = 0;
+
+    if (x86KSidleNumStates != 0) {
+        next_tick = (uint64_t)apic_read_reg(APIC_TIMER_CURRENT) * x86KSidleTscPerApicTick;
+        if (next_tick < predicted) {
+            predicted = next_tick;
+        }
+
+        while (state + 1 < x86KSidleNumStates &&
+                x86KSidleStates[state + 1].target_residency <= predicted) {
+            state++;
+        }
+        setRegister(NODE_STATE(ksIdleThread), idleHintRegister, x86KSidleStates[state].hint);
+    }
+
+    ARCH_NODE_STATE(x86KSidleState) = state;
+    ARCH_NODE_STATE(x86KSidleEnterTime) = x86_rdtsc();
+}
+
+/* Called on kernel entry from the idle thread */
+void
+x86_idle_wake(void)
+{
+    uint64_t now = x86_rdtsc();
+    uint64_t residency = now - ARCH_NODE_STATE(x86KSidleEnterTime);
+    uint64_t predicted = ARCH_NODE_STATE(x86KSidlePredicted);
+
+    /* moving average giving the latest idle period a weight of 1/8 */
+    ARCH_NODE_STATE(x86KSidlePredicted) = predicted - (predicted >> 3) + (residency >> 3);
+
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    x86_idle_stats_t *stats = &ARCH_NODE_STATE(x86KSidleStats);
+
+    stats->entries++;
+    stats->residency += residency;
+    if (ARCH_NODE_STATE(x86KSidleState) != 0) {
+        stats->deep_entries++;
+    }
+    /* This runs before the kernel lock is taken, while other cores record
+     * wake requests with the lock held, so the request is claimed atomically */
+    uint64_t request = __atomic_exchange_n(&ARCH_NODE_STATE(x86KSidleWakeRequest), 0, __ATOMIC_RELAXED);
+    if (request != 0) {
+        stats->ipi_wakeups++;
+        stats->wake_latency += now - request;
+    }
+#endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+}
+
+#if defined(ENABLE_SMP_SUPPORT) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION)
+/* Record the time at which the idle cores in mask were sent an IPI. This is
+ * called with the kernel lock held, and idle cores only change their current
+ * thread after acquiring it. The woken core claims the request in its entry
+ * hook before acquiring the lock, so the request is only set atomically if
+ * no earlier one is pending */
+void
+x86_idle_mark_wake_request(word_t mask)
+{
+    uint64_t now = x86_rdtsc();
+
+    while (mask) {
+        word_t index = wordBits - 1 - clzl(mask);
+        if (NODE_STATE_ON_CORE(ksCurThread, index) == NODE_STATE_ON_CORE(ksIdleThread, index)) {
+            uint64_t pending = 0;
+            __atomic_compare_exchange_n(&ARCH_NODE_STATE_ON_CORE(x86KSidleWakeRequest, index),
+                                        &pending, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        mask &= ~BIT(index);
+    }
+}
+#endif /* ENABLE_SMP_SUPPORT && CONFIG_BENCHMARK_TRACK_UTILISATION */
+#endif /* CONFIG_X86_IDLE_MWAIT */
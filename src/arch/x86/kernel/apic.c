@@ -15,6 +15,7 @@
 #include <linker.h>
 #include <plat/machine/devices.h>
 #include <plat/machine/pit.h>
+#include <model/statedata.h>
 
 static BOOT_CODE uint32_t
 apic_measure_freq(void)
@@ -43,18 +44,29 @@ apic_get_base_paddr(void)
     return apic_base_msr_get_base_addr(apic_base_msr);
 }
 
+/* APIC timer frequency, measured by the BSP and reused by the APs so that they
+ * do not need the PIT, which allows them to initialise concurrently */
+BOOT_DATA static uint32_t apic_khz;
+
+BOOT_CODE uint32_t
+apic_get_timer_khz(void)
+{
+    return apic_khz;
+}
+
 BOOT_CODE bool_t
 apic_init(bool_t mask_legacy_irqs)
 {
     apic_version_t apic_version;
     uint32_t num_lvt_entries;
-    uint32_t apic_khz;
 
     if (!apic_enable()) {
         return false;
     }
 
-    apic_khz = apic_measure_freq();
+    if (SMP_TERNARY(getCurrentCPUIndex(), 0) == 0) {
+        apic_khz = apic_measure_freq();
+    }
 
     apic_version.words[0] = apic_read_reg(APIC_VERSION);
 
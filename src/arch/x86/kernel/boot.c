@@ -19,6 +19,8 @@
 #include <arch/kernel/boot.h>
 #include <arch/kernel/boot_sys.h>
 #include <arch/kernel/vspace.h>
+#include <arch/kernel/idle.h>
+#include <arch/kernel/kernelinfo.h>
 #include <machine/fpu.h>
 #include <arch/machine/timer.h>
 #include <arch/object/ioport.h>
@@ -26,6 +28,7 @@
 #include <util.h>
 
 #include <plat/machine/intel-vtd.h>
+#include <benchmark/benchmark_boot.h>
 
 /* functions exactly corresponding to abstract specification */
 
@@ -44,6 +47,10 @@ init_irqs(cap_t root_cnode_cap)
 #ifdef CONFIG_IOMMU
         } else if (i == irq_iommu) {
             setIRQState(IRQReserved, i);
+#endif
+#ifdef CONFIG_VTX
+        } else if (i == irq_vtx_posted_interrupt) {
+            setIRQState(IRQReserved, i);
 #endif
         } else if (i == 2 && config_set(CONFIG_IRQ_PIC)) {
             /* cascaded legacy PIC */
@@ -214,6 +221,65 @@ create_untypeds(
     return true;
 }
 
+BOOT_CODE static void
+populate_topology_bi(seL4_X86_BootInfo_Topology_t *topology_bi, uint32_t num_cpus, cpu_id_t *cpus)
+{
+    cpu_identity_t *ci = x86_cpuid_get_identity();
+    word_t i;
+
+    topology_bi->header.id = SEL4_BOOTINFO_HEADER_X86_TOPOLOGY;
+    topology_bi->header.len = sizeof(seL4_X86_BootInfo_Topology_t);
+    topology_bi->numNodes = num_cpus;
+    for (i = 0; i < num_cpus; i++) {
+        topology_bi->nodes[i].apicID = cpus[i];
+        topology_bi->nodes[i].package = cpus[i] >> ci->core_shift;
+        topology_bi->nodes[i].core = (cpus[i] & MASK(ci->core_shift)) >> ci->smt_shift;
+        topology_bi->nodes[i].thread = cpus[i] & MASK(ci->smt_shift);
+    }
+}
+
+#ifdef CONFIG_NUMA
+compile_assert(numa_node_invalid_matches, NUMA_NODE_INVALID == SEL4_X86_NUMA_NODE_INVALID)
+
+BOOT_CODE static void
+populate_numa_bi(seL4_X86_BootInfo_NUMA_t *numa_bi, acpi_numa_info_t *numa_info)
+{
+    word_t i;
+
+    numa_bi->header.id = SEL4_BOOTINFO_HEADER_X86_NUMA;
+    numa_bi->header.len = sizeof(seL4_X86_BootInfo_NUMA_t);
+    numa_bi->numNUMANodes = numa_info->num_nodes;
+    for (i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+        numa_bi->cpuNode[i] = numa_info->cpu_node[i];
+    }
+    memcpy(numa_bi->distance, numa_info->distance, sizeof(numa_bi->distance));
+    for (i = 0; i < CONFIG_MAX_NUM_BOOTINFO_UNTYPED_CAPS; i++) {
+        numa_bi->untypedNode[i] = SEL4_X86_NUMA_NODE_INVALID;
+    }
+}
+
+/* Tag each untyped with the NUMA node whose memory contains all of it */
+BOOT_CODE static void
+populate_numa_bi_untypeds(seL4_X86_BootInfo_NUMA_t *numa_bi, acpi_numa_info_t *numa_info)
+{
+    seL4_SlotRegion untyped = ndks_boot.bi_frame->untyped;
+    word_t i, j;
+
+    for (i = 0; i < untyped.end - untyped.start; i++) {
+        seL4_UntypedDesc *desc = &ndks_boot.bi_frame->untypedList[i];
+        paddr_t start = desc->paddr;
+        paddr_t end = start + BIT(desc->sizeBits);
+
+        for (j = 0; j < numa_info->num_mem_regions; j++) {
+            if (numa_info->mem_regions[j].start <= start && end <= numa_info->mem_regions[j].end) {
+                numa_bi->untypedNode[i] = numa_info->mem_regions[j].node;
+                break;
+            }
+        }
+    }
+}
+#endif /* CONFIG_NUMA */
+
 BOOT_CODE static void
 init_freemem(p_region_t ui_p_reg, mem_p_regs_t mem_p_regs)
 {
@@ -254,7 +320,12 @@ init_sys_state(
     acpi_rsdp_t      *acpi_rsdp,
     seL4_X86_BootInfo_VBE *vbe,
     seL4_X86_BootInfo_mmap_t *mb_mmap,
-    seL4_X86_BootInfo_fb_t *fb_info
+    seL4_X86_BootInfo_fb_t *fb_info,
+    uint32_t      num_cpus,
+    cpu_id_t     *cpus
+#ifdef CONFIG_NUMA
+    , acpi_numa_info_t *numa_info
+#endif
 )
 {
     cap_t         root_cnode_cap;
@@ -271,6 +342,12 @@ init_sys_state(
     uint32_t      tsc_freq;
     create_frames_of_region_ret_t create_frames_ret;
     create_frames_of_region_ret_t extra_bi_ret;
+#ifdef CONFIG_NUMA
+    seL4_X86_BootInfo_NUMA_t *numa_bi;
+#endif
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    seL4_BootInfo_KernelInfo_t *kernel_info_bi;
+#endif
 
     /* convert from physical addresses to kernel pptrs */
     region_t ui_reg             = paddr_to_pptr_reg(ui_info.p_reg);
@@ -279,6 +356,7 @@ init_sys_state(
     /* convert from physical addresses to userland vptrs */
     v_region_t ui_v_reg;
     v_region_t it_v_reg;
+    v_region_t ui_large_v_reg = V_REG_EMPTY;
     ui_v_reg.start = ui_info.p_reg.start - ui_info.pv_offset;
     ui_v_reg.end   = ui_info.p_reg.end   - ui_info.pv_offset;
 
@@ -302,11 +380,33 @@ init_sys_state(
     // room for tsc frequency
     extra_bi_size += sizeof(seL4_BootInfoHeader) + 4;
 
+    extra_bi_size += sizeof(seL4_X86_BootInfo_Topology_t);
+
+#ifdef CONFIG_NUMA
+    extra_bi_size += sizeof(seL4_X86_BootInfo_NUMA_t);
+#endif
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    extra_bi_size += sizeof(seL4_BootInfo_KernelInfo_t);
+#endif
+
+    extra_bi_size += BENCHMARK_BOOT_PROFILE_SIZE;
+
     /* The region of the initial thread is the user image + ipcbuf and boot info */
     it_v_reg.start = ui_v_reg.start;
     it_v_reg.end = ROUND_UP(extra_bi_frame_vptr + extra_bi_size, PAGE_BITS);
 
     init_freemem(ui_info.p_reg, mem_p_regs);
+    if (!insert_region(paddr_to_pptr_reg(ui_info.pad_p_reg))) {
+        return false;
+    }
+    benchmark_boot_phase(0, seL4_BootPhase_FreeMemory);
+
+    /* The part of the user image that will be mapped with large frames, which
+     * therefore needs no page tables */
+    if (config_set(CONFIG_ROOT_TASK_LARGE_PAGES)) {
+        ui_large_v_reg = large_frames_of_region(ui_reg, ui_info.pv_offset);
+    }
 
     /* create the root cnode */
     root_cnode_cap = create_root_cnode();
@@ -336,6 +436,10 @@ init_sys_state(
 
     tsc_freq = tsc_init();
 
+#ifdef CONFIG_X86_IDLE_MWAIT
+    x86_idle_init(tsc_freq);
+#endif
+
     /* create the bootinfo frame */
     bi_frame_pptr = allocate_bi_frame(0, ksNumCPUs, ipcbuf_vptr);
     if (!bi_frame_pptr) {
@@ -394,6 +498,31 @@ init_sys_state(
         extra_bi_offset += 4;
     }
 
+    /* populate processor topology block */
+    populate_topology_bi((seL4_X86_BootInfo_Topology_t*)(extra_bi_region.start + extra_bi_offset),
+                         num_cpus, cpus);
+    extra_bi_offset += sizeof(seL4_X86_BootInfo_Topology_t);
+
+#ifdef CONFIG_NUMA
+    /* populate NUMA topology block, the nodes of the untypeds are filled in
+     * once they have been created */
+    numa_bi = (seL4_X86_BootInfo_NUMA_t*)(extra_bi_region.start + extra_bi_offset);
+    populate_numa_bi(numa_bi, numa_info);
+    extra_bi_offset += sizeof(seL4_X86_BootInfo_NUMA_t);
+#endif
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    /* reserve the kernel info block, it is filled in once the page is created */
+    kernel_info_bi = (seL4_BootInfo_KernelInfo_t*)(extra_bi_region.start + extra_bi_offset);
+    extra_bi_offset += sizeof(seL4_BootInfo_KernelInfo_t);
+#endif
+
+#ifdef CONFIG_BENCHMARK_BOOT_PROFILING
+    /* reserve the boot profile, it is filled in once all nodes have booted */
+    benchmark_boot_init_bi((seL4_BootInfo_Profile_t*)(extra_bi_region.start + extra_bi_offset));
+    extra_bi_offset += BENCHMARK_BOOT_PROFILE_SIZE;
+#endif
+
     /* provde a chunk for any leftover padding in the extended boot info */
     seL4_BootInfoHeader padding_header;
     padding_header.id = SEL4_BOOTINFO_HEADER_PADDING;
@@ -402,7 +531,7 @@ init_sys_state(
 
     /* Construct an initial address space with enough virtual addresses
      * to cover the user image + ipc buffer and bootinfo frames */
-    it_vspace_cap = create_it_address_space(root_cnode_cap, it_v_reg);
+    it_vspace_cap = create_it_address_space(root_cnode_cap, it_v_reg, ui_large_v_reg);
     if (cap_get_capType(it_vspace_cap) == cap_null_cap) {
         return false;
     }
@@ -422,7 +551,8 @@ init_sys_state(
             it_vspace_cap,
             extra_bi_region,
             true,
-            pptr_to_paddr((void*)(extra_bi_region.start - extra_bi_frame_vptr))
+            pptr_to_paddr((void*)(extra_bi_region.start - extra_bi_frame_vptr)),
+            false
         );
     if (!extra_bi_ret.success) {
         return false;
@@ -442,12 +572,19 @@ init_sys_state(
             it_vspace_cap,
             ui_reg,
             true,
-            ui_info.pv_offset
+            ui_info.pv_offset,
+            config_set(CONFIG_ROOT_TASK_LARGE_PAGES)
         );
     if (!create_frames_ret.success) {
         return false;
     }
     ndks_boot.bi_frame->userImageFrames = create_frames_ret.region;
+    if (config_set(CONFIG_ROOT_TASK_LARGE_PAGES)) {
+        printf("Mapped userland image with %lu frames and %lu paging structures\n",
+               create_frames_ret.region.end - create_frames_ret.region.start,
+               ndks_boot.bi_frame->userImagePaging.end - ndks_boot.bi_frame->userImagePaging.start);
+    }
+    benchmark_boot_phase(0, seL4_BootPhase_RootVSpace);
 
     /* create the initial thread's ASID pool */
     it_ap_cap = create_it_asid_pool(root_cnode_cap);
@@ -484,14 +621,27 @@ init_sys_state(
 
     /* write IOSpace master cap */
     write_slot(SLOT_PTR(pptr_of_cap(root_cnode_cap), seL4_CapIOSpace), master_iospace_cap());
+    benchmark_boot_phase(0, seL4_BootPhase_IOMMU);
 #else
     ndks_boot.bi_frame->numIOPTLevels = -1;
 #endif
 
+#ifdef CONFIG_KERNEL_INFO_PAGE
+    /* create the kernel info page and provide a read-only cap to it */
+    if (!x86_kernel_info_init(root_cnode_cap, kernel_info_bi, tsc_freq)) {
+        return false;
+    }
+#endif
+
     /* create all of the untypeds. Both devices and kernel window memory */
     if (!create_untypeds(root_cnode_cap, boot_mem_reuse_reg)) {
         return false;
     }
+    benchmark_boot_phase(0, seL4_BootPhase_Untypeds);
+
+#ifdef CONFIG_NUMA
+    populate_numa_bi_untypeds(numa_bi, numa_info);
+#endif
     /* WARNING: alloc_region() must not be called anymore after here! */
 
     /* finalise the bootinfo frame */
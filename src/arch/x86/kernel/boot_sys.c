@@ -21,6 +21,7 @@
 #include <arch/kernel/elf.h>
 #include <smp/lock.h>
 #include <linker.h>
+#include <benchmark/benchmark_boot.h>
 #include <plat/machine/acpi.h>
 #include <plat/machine/devices.h>
 #include <plat/machine/pic.h>
@@ -74,6 +75,9 @@ typedef struct boot_state {
     seL4_X86_BootInfo_VBE vbe_info; /* Potential VBE information from multiboot */
     seL4_X86_BootInfo_mmap_t mb_mmap_info; /* memory map information from multiboot */
     seL4_X86_BootInfo_fb_t fb_info; /* framebuffer information as set by bootloader */
+#ifdef CONFIG_NUMA
+    acpi_numa_info_t numa_info; /* NUMA topology from the SRAT and SLIT */
+#endif
 } boot_state_t;
 
 BOOT_BSS
@@ -225,6 +229,7 @@ try_boot_sys_node(cpu_id_t cpu_id)
     if (!init_cpu(config_set(CONFIG_IRQ_IOAPIC) ? 1 : 0)) {
         return false;
     }
+    benchmark_boot_phase(0, seL4_BootPhase_CPU);
 
     /* initialise NDKS and kernel heap */
     if (!init_sys_state(
@@ -239,7 +244,12 @@ try_boot_sys_node(cpu_id_t cpu_id)
                 &boot_state.acpi_rsdp,
                 &boot_state.vbe_info,
                 &boot_state.mb_mmap_info,
-                &boot_state.fb_info
+                &boot_state.fb_info,
+                boot_state.num_cpus,
+                boot_state.cpus
+#ifdef CONFIG_NUMA
+                , &boot_state.numa_info
+#endif
             )) {
         return false;
     }
@@ -271,6 +281,45 @@ add_mem_p_regs(p_region_t reg)
     return add_allocated_p_region(reg);
 }
 
+#ifdef CONFIG_NUMA
+/* Split the physical memory region containing the given address at it */
+static BOOT_CODE void
+split_mem_p_regs(paddr_t paddr)
+{
+    word_t i;
+
+    for (i = 0; i < boot_state.mem_p_regs.count; i++) {
+        p_region_t reg = boot_state.mem_p_regs.list[i];
+        if (reg.start < paddr && paddr < reg.end) {
+            if (boot_state.mem_p_regs.count == MAX_NUM_FREEMEM_REG) {
+                printf("Cannot split memory region 0x%lx-0x%lx on a NUMA node boundary, "
+                       "try increasing MAX_NUM_FREEMEM_REG\n", reg.start, reg.end);
+                return;
+            }
+            boot_state.mem_p_regs.list[i].end = paddr;
+            boot_state.mem_p_regs.list[boot_state.mem_p_regs.count] = (p_region_t) {
+                paddr, reg.end
+            };
+            boot_state.mem_p_regs.count++;
+            return;
+        }
+    }
+}
+
+/* Split the physical memory regions on NUMA node boundaries, so that
+ * none of the untypeds created from them spans more than one node */
+static BOOT_CODE void
+split_mem_p_regs_numa(void)
+{
+    word_t i;
+
+    for (i = 0; i < boot_state.numa_info.num_mem_regions; i++) {
+        split_mem_p_regs(boot_state.numa_info.mem_regions[i].start);
+        split_mem_p_regs(boot_state.numa_info.mem_regions[i].end);
+    }
+}
+#endif /* CONFIG_NUMA */
+
 /*
  * the code relies that the GRUB provides correct information
  * about the actual physical memory regions.
@@ -495,6 +544,12 @@ try_boot_sys(void)
         return false;
     }
 
+#ifdef CONFIG_NUMA
+    /* query the NUMA topology from ACPI */
+    acpi_numa_scan(&boot_state.acpi_rsdp, boot_state.cpus, boot_state.num_cpus, &boot_state.numa_info);
+    split_mem_p_regs_numa();
+#endif
+
     if (config_set(CONFIG_IRQ_IOAPIC)) {
         if (boot_state.num_ioapic == 0) {
             printf("No IOAPICs detected\n");
@@ -519,6 +574,19 @@ try_boot_sys(void)
 
     /* calculate final location of userland images */
     ui_p_regs.start = boot_state.ki_p_reg.end;
+    if (config_set(CONFIG_ROOT_TASK_LARGE_PAGES)) {
+        /* move the images up so that their physical and virtual addresses
+         * agree modulo the large page size, as long as that does not take
+         * them past where they were loaded. The skipped memory is made
+         * available again as free memory */
+        paddr_t aligned_start = ui_p_regs.start +
+                                ((mods_end_paddr - boot_state.ui_info.pv_offset - ui_p_regs.start) & MASK(seL4_LargePageBits));
+        if (aligned_start <= mods_end_paddr) {
+            boot_state.ui_info.pad_p_reg.start = ui_p_regs.start;
+            boot_state.ui_info.pad_p_reg.end = aligned_start;
+            ui_p_regs.start = aligned_start;
+        }
+    }
     ui_p_regs.end = ui_p_regs.start + load_paddr - mods_end_paddr;
 
     printf(
@@ -543,6 +611,8 @@ try_boot_sys(void)
     /* Total number of cores we intend to boot */
     ksNumCPUs = boot_state.num_cpus;
 
+    benchmark_boot_phase(0, seL4_BootPhase_Platform);
+
     printf("Starting node #0 with APIC ID %lu\n", boot_state.cpus[0]);
     if (!try_boot_sys_node(boot_state.cpus[0])) {
         return false;
@@ -555,10 +625,15 @@ try_boot_sys(void)
     /* initialize BKL before booting up APs */
     SMP_COND_STATEMENT(clh_lock_init());
     SMP_COND_STATEMENT(start_boot_aps());
+    benchmark_boot_phase(0, seL4_BootPhase_SecondaryCores);
 
     /* grab BKL before leaving the kernel */
     NODE_LOCK_SYS;
 
+#ifdef CONFIG_BENCHMARK_BOOT_PROFILING
+    benchmark_boot_finalise();
+#endif
+
     printf("Booting all finished, dropped to user space\n");
 
     return true;
@@ -769,6 +844,8 @@ boot_sys(
 {
     bool_t result = false;
 
+    benchmark_boot_phase(0, seL4_BootPhase_Entry);
+
     if (multiboot_magic == MULTIBOOT_MAGIC) {
         result = try_boot_sys_mbi1(mbi);
     } else if (multiboot_magic == MULTIBOOT2_MAGIC) {
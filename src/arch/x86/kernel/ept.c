@@ -15,6 +15,7 @@
 #ifdef CONFIG_VTX
 
 #include <model/statedata.h>
+#include <model/preemption.h>
 #include <arch/kernel/ept.h>
 #include <arch/api/invocation.h>
 
@@ -88,11 +89,13 @@ findEPTForASID(asid_t asid)
         current_lookup_fault = lookup_fault_invalid_root_new();
 
         ret.ept = NULL;
+        ret.ad_enabled = false;
         ret.status = EXCEPTION_LOOKUP_FAULT;
         return ret;
     }
 
     ret.ept = (ept_pml4e_t*)asid_map_asid_map_ept_get_ept_root(asid_map);
+    ret.ad_enabled = asid_map_asid_map_ept_get_ad_enabled(asid_map);
     ret.status = EXCEPTION_NONE;
     return ret;
 }
@@ -142,7 +145,8 @@ lookupEPTPDSlot(ept_pml4e_t* pml4, vptr_t vptr)
         return ret;
     }
 
-    if (!ept_pdpte_ptr_get_read(lu_ret.pdptSlot)) {
+    if ((ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) != ept_pdpte_ept_pdpte_pd) ||
+            !ept_pdpte_ept_pdpte_pd_ptr_get_read(lu_ret.pdptSlot)) {
         current_lookup_fault = lookup_fault_missing_capability_new(22);
 
         ret.pdSlot = NULL;
@@ -150,7 +154,7 @@ lookupEPTPDSlot(ept_pml4e_t* pml4, vptr_t vptr)
         return ret;
     }
 
-    ept_pde_t *pd = paddr_to_pptr(ept_pdpte_ptr_get_pd_base_address(lu_ret.pdptSlot));
+    ept_pde_t *pd = paddr_to_pptr(ept_pdpte_ept_pdpte_pd_ptr_get_pd_base_address(lu_ret.pdptSlot));
     uint32_t index = GET_EPT_PD_INDEX(vptr);
     ret.pdSlot = pd + index;
     ret.status = EXCEPTION_NONE;
@@ -381,6 +385,227 @@ decodeX86EPTPDPTInvocation(
     return performEPTPDPTInvocationMap(cap, cte, pml4e, pml4Slot, pml4);
 }
 
+static exception_t
+performEPTPML4InvocationEnableAccessDirty(asid_t asid, ept_pml4e_t *pml4)
+{
+    asid_pool_t *poolPtr;
+
+    poolPtr = x86KSASIDTable[asid >> asidLowBits];
+    assert(poolPtr != NULL);
+    poolPtr->array[asid & MASK(asidLowBits)] = asid_map_asid_map_ept_new(
+                                                   (word_t)pml4,
+                                                   1  /* accessed and dirty flags enabled */
+                                               );
+    /* Translations cached before the flags were enabled would allow writes
+     * to complete without setting the dirty flag, so throw them away. Any
+     * VCPU using this EPT picks up the new EPTP on its next entry */
+    invept(pml4);
+
+    return EXCEPTION_NONE;
+}
+
+static inline uint64_t CONST
+eptNextBoundary(uint64_t addr, word_t bits)
+{
+    return (addr | (((uint64_t)1 << bits) - 1)) + 1;
+}
+
+static exception_t
+performEPTPML4InvocationHarvestDirty(ept_pml4e_t *pml4, word_t gpa, word_t pages, word_t *buffer)
+{
+    word_t bitmap[seL4_X86_EPTDirtyBitmapWords] = { 0 };
+    uint64_t start = gpa;
+    uint64_t end = start + ((uint64_t)pages << seL4_PageBits);
+    uint64_t addr = start;
+    bool_t cleared = false;
+    tcb_t *thread;
+    word_t i;
+
+    while (addr < end) {
+        ept_pml4e_t *pml4Slot = lookupEPTPML4Slot(pml4, addr);
+        uint64_t next;
+        word_t leafBits = 0;
+        bool_t dirty = false;
+
+        /* Walk to the leaf entry covering addr. 'next' is the first address
+         * after the region described by the entry we stop at, and a non zero
+         * leafBits gives the size of the mapping if there was one */
+        if (!ept_pml4e_ptr_get_read(pml4Slot)) {
+            next = eptNextBoundary(addr, EPT_PML4_INDEX_OFFSET);
+        } else {
+            ept_pdpte_t *pdptSlot = (ept_pdpte_t*)paddr_to_pptr(ept_pml4e_ptr_get_pdpt_base_address(pml4Slot))
+                                    + GET_EPT_PDPT_INDEX(addr);
+            next = eptNextBoundary(addr, EPT_PDPT_INDEX_OFFSET);
+            if (ept_pdpte_ptr_get_page_size(pdptSlot) == ept_pdpte_ept_pdpte_1g) {
+                if (ept_pdpte_ept_pdpte_1g_ptr_get_read(pdptSlot)) {
+                    leafBits = EPT_PDPT_INDEX_OFFSET;
+                    dirty = ept_pdpte_ept_pdpte_1g_ptr_get_dirty(pdptSlot);
+                    if (dirty) {
+                        ept_pdpte_ept_pdpte_1g_ptr_set_dirty(pdptSlot, 0);
+                        cleared = true;
+                    }
+                }
+            } else if (ept_pdpte_ept_pdpte_pd_ptr_get_read(pdptSlot)) {
+                ept_pde_t *pdSlot = (ept_pde_t*)paddr_to_pptr(ept_pdpte_ept_pdpte_pd_ptr_get_pd_base_address(pdptSlot))
+                                    + GET_EPT_PD_INDEX(addr);
+                next = eptNextBoundary(addr, EPT_PD_INDEX_OFFSET);
+                if (ept_pde_ptr_get_page_size(pdSlot) == ept_pde_ept_pde_2m) {
+                    if (ept_pde_ept_pde_2m_ptr_get_read(pdSlot)) {
+                        leafBits = EPT_PD_INDEX_OFFSET;
+                        dirty = ept_pde_ept_pde_2m_ptr_get_dirty(pdSlot);
+                        if (dirty) {
+                            ept_pde_ept_pde_2m_ptr_set_dirty(pdSlot, 0);
+                            cleared = true;
+                        }
+                    }
+                } else if (ept_pde_ept_pde_pt_ptr_get_read(pdSlot)) {
+                    ept_pte_t *ptSlot = (ept_pte_t*)paddr_to_pptr(ept_pde_ept_pde_pt_ptr_get_pt_base_address(pdSlot))
+                                        + GET_EPT_PT_INDEX(addr);
+                    next = eptNextBoundary(addr, EPT_PT_INDEX_OFFSET);
+                    if (ept_pte_ptr_get_read(ptSlot)) {
+                        leafBits = EPT_PT_INDEX_OFFSET;
+                        dirty = ept_pte_ptr_get_dirty(ptSlot);
+                        if (dirty) {
+                            ept_pte_ptr_set_dirty(ptSlot, 0);
+                            cleared = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (next > end) {
+            next = end;
+        }
+        /* A dirty large mapping is reported as dirty for every page of it
+         * that is within the range, and its dirty flag is cleared even if the
+         * range only covers part of it, as a 1G mapping is larger than any
+         * range. The caller must treat the whole mapping as dirty */
+        if (leafBits != 0 && dirty) {
+            word_t page;
+            for (page = (addr - start) >> seL4_PageBits; page < (next - start) >> seL4_PageBits; page++) {
+                bitmap[page / wordBits] |= BIT(page % wordBits);
+            }
+        }
+        addr = next;
+
+        /* Rather than restarting the invocation, which would lose the dirty
+         * flags already cleared, stop early and report how far we got */
+        if (preemptionPoint() != EXCEPTION_NONE) {
+            break;
+        }
+    }
+
+    if (cleared) {
+        invept(pml4);
+    }
+
+    thread = NODE_STATE(ksCurThread);
+    setMR(thread, buffer, 0, (addr - start) >> seL4_PageBits);
+    for (i = 0; i < seL4_X86_EPTDirtyBitmapWords; i++) {
+        setMR(thread, buffer, i + 1, bitmap[i]);
+    }
+    setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                    seL4_MessageInfo_new(0, 0, 0, seL4_X86_EPTDirtyBitmapWords + 1)));
+    setThreadState(thread, ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeX86EPTPML4Invocation(
+    word_t invLabel,
+    word_t length,
+    cte_t *cte,
+    cap_t cap,
+    word_t *buffer
+)
+{
+    ept_pml4e_t*    pml4;
+    asid_t          asid;
+    word_t          gpa;
+    word_t          pages;
+    findEPTForASID_ret_t find_ret;
+
+    if (invLabel != X86EPTPML4EnableAccessDirty && invLabel != X86EPTPML4HarvestDirty) {
+        userError("X86EPTPML4: Illegal operation.");
+        current_syscall_error.type = seL4_IllegalOperation;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (!cap_ept_pml4_cap_get_capPML4IsMapped(cap)) {
+        userError("X86EPTPML4: EPT PML4 is not assigned an ASID.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    pml4 = (ept_pml4e_t*)cap_ept_pml4_cap_get_capPML4BasePtr(cap);
+    asid = cap_ept_pml4_cap_get_capPML4MappedASID(cap);
+
+    find_ret = findEPTForASID(asid);
+    if (find_ret.status != EXCEPTION_NONE) {
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (find_ret.ept != pml4) {
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (invLabel == X86EPTPML4EnableAccessDirty) {
+        if (!vtx_ept_ad_supported()) {
+            userError("X86EPTPML4EnableAccessDirty: Hardware does not support EPT accessed and dirty flags.");
+            current_syscall_error.type = seL4_IllegalOperation;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        return performEPTPML4InvocationEnableAccessDirty(asid, pml4);
+    }
+
+    if (length < 2) {
+        userError("X86EPTPML4HarvestDirty: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    gpa = getSyscallArg(0, buffer);
+    pages = getSyscallArg(1, buffer);
+
+    if (!find_ret.ad_enabled) {
+        userError("X86EPTPML4HarvestDirty: Accessed and dirty flags are not enabled.");
+        current_syscall_error.type = seL4_IllegalOperation;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (!IS_ALIGNED(gpa, seL4_PageBits)) {
+        userError("X86EPTPML4HarvestDirty: Guest physical address is not page aligned.");
+        current_syscall_error.type = seL4_AlignmentError;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (pages == 0 || pages > seL4_X86_EPTDirtyBitmapWords * wordBits) {
+        userError("X86EPTPML4HarvestDirty: Invalid number of pages %ld.", (long)pages);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = seL4_X86_EPTDirtyBitmapWords * wordBits;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (gpa + (pages << seL4_PageBits) - 1 < gpa ||
+            ((uint64_t)(gpa + (pages << seL4_PageBits) - 1) >> (EPT_PML4_INDEX_OFFSET + EPT_PML4_INDEX_BITS)) != 0) {
+        userError("X86EPTPML4HarvestDirty: Range exceeds the guest physical address space.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performEPTPML4InvocationHarvestDirty(pml4, gpa, pages, buffer);
+}
+
 exception_t
 decodeX86EPTInvocation(
     word_t invLabel,
@@ -393,6 +618,8 @@ decodeX86EPTInvocation(
 )
 {
     switch (cap_get_capType(cap)) {
+    case cap_ept_pml4_cap:
+        return decodeX86EPTPML4Invocation(invLabel, length, cte, cap, buffer);
     case cap_ept_pdpt_cap:
         return decodeX86EPTPDPTInvocation(invLabel, length, cte, cap, excaps, buffer);
     case cap_ept_pd_cap:
@@ -427,8 +654,9 @@ EPTPageDirectoryMapped(asid_t asid, vptr_t vaddr, ept_pde_t *pd)
         return ret;
     }
 
-    if (ept_pdpte_ptr_get_read(find_ret.pdptSlot)
-            && ptrFromPAddr(ept_pdpte_ptr_get_pd_base_address(find_ret.pdptSlot)) == pd) {
+    if (ept_pdpte_ptr_get_page_size(find_ret.pdptSlot) == ept_pdpte_ept_pdpte_pd
+            && ept_pdpte_ept_pdpte_pd_ptr_get_read(find_ret.pdptSlot)
+            && ptrFromPAddr(ept_pdpte_ept_pdpte_pd_ptr_get_pd_base_address(find_ret.pdptSlot)) == pd) {
         ret.pml4 = asid_ret.ept;
         ret.pdptSlot = find_ret.pdptSlot;
         ret.status = EXCEPTION_NONE;
@@ -449,7 +677,7 @@ unmapEPTPageDirectory(asid_t asid, vptr_t vaddr, ept_pde_t *pd)
     lu_ret = EPTPageDirectoryMapped(asid, vaddr, pd);
 
     if (lu_ret.status == EXCEPTION_NONE) {
-        *lu_ret.pdptSlot = ept_pdpte_new(
+        *lu_ret.pdptSlot = ept_pdpte_ept_pdpte_pd_new(
                                0,  /* pd_base_address  */
                                0,  /* avl_cte_depth    */
                                0,  /* execute          */
@@ -574,14 +802,21 @@ decodeX86EPTPDInvocation(
         return EXCEPTION_SYSCALL_ERROR;
     }
 
-    if (ept_pdpte_ptr_get_read(lu_ret.pdptSlot)) {
+    if ((ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) == ept_pdpte_ept_pdpte_pd) &&
+            ept_pdpte_ept_pdpte_pd_ptr_get_read(lu_ret.pdptSlot)) {
         userError("X86EPTPDMap: Page directory already mapped here.");
         current_syscall_error.type = seL4_DeleteFirst;
         return EXCEPTION_SYSCALL_ERROR;
     }
+    if ((ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) == ept_pdpte_ept_pdpte_1g) &&
+            ept_pdpte_ept_pdpte_1g_ptr_get_read(lu_ret.pdptSlot)) {
+        userError("X86EPTPDMap: Huge page already mapped here.");
+        current_syscall_error.type = seL4_DeleteFirst;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
 
     paddr = pptr_to_paddr((void*)(cap_ept_pd_cap_get_capPDBasePtr(cap)));
-    pdpte = ept_pdpte_new(
+    pdpte = ept_pdpte_ept_pdpte_pd_new(
                 paddr,  /* pd_base_address  */
                 0,      /* avl_cte_depth    */
                 1,      /* execute          */
@@ -816,6 +1051,18 @@ performEPTPageMapPDE(cap_t cap, cte_t *cte, ept_pde_t *pdSlot, ept_pde_t pde1, e
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_HUGE_PAGE
+static exception_t
+performEPTPageMapPDPTE(cap_t cap, cte_t *cte, ept_pdpte_t *pdptSlot, ept_pdpte_t pdpte, ept_pml4e_t *pml4)
+{
+    *pdptSlot = pdpte;
+    cte->cap = cap;
+    invept(pml4);
+
+    return EXCEPTION_NONE;
+}
+#endif
+
 exception_t
 decodeX86EPTPageMap(
     word_t invLabel,
@@ -921,6 +1168,8 @@ decodeX86EPTPageMap(
                   paddr,
                   0,
                   0,
+                  0,
+                  0,
                   eptCacheFromVmAttr(vmAttr),
                   1,
                   WritableFromVMRights(vmRights),
@@ -968,6 +1217,8 @@ decodeX86EPTPageMap(
                              paddr,
                              0,
                              0,
+                             0,
+                             0,
                              eptCacheFromVmAttr(vmAttr),
                              1,
                              WritableFromVMRights(vmRights),
@@ -977,6 +1228,8 @@ decodeX86EPTPageMap(
                              paddr + BIT(EPT_PD_INDEX_OFFSET),
                              0,
                              0,
+                             0,
+                             0,
                              eptCacheFromVmAttr(vmAttr),
                              1,
                              WritableFromVMRights(vmRights),
@@ -986,9 +1239,62 @@ decodeX86EPTPageMap(
         return performEPTPageMapPDE(cap, cte, lu_ret.pdSlot, pde1, pde2, pml4);
     }
 
+#ifdef CONFIG_HUGE_PAGE
+    /* PDPTE mappings */
+    case X64_HugePage: {
+        lookupEPTPDPTSlot_ret_t lu_ret;
+        ept_pdpte_t pdpte;
+
+        /* 1GiB pages are an optional EPT feature, unlike 2M pages which
+         * are required when initializing EPT */
+        if (!vtx_ept_1g_supported()) {
+            userError("X86EPTPageMap: Hardware does not support 1GiB EPT pages.");
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 0;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        lu_ret = lookupEPTPDPTSlot(pml4, vaddr);
+        if (lu_ret.status != EXCEPTION_NONE) {
+            userError("X86EPTPageMap: Need a page directory page table first.");
+            current_syscall_error.type = seL4_FailedLookup;
+            current_syscall_error.failedLookupWasSource = false;
+            /* current_lookup_fault will have been set by lookupEPTPDPTSlot */
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        if ((ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) == ept_pdpte_ept_pdpte_pd) &&
+                ept_pdpte_ept_pdpte_pd_ptr_get_read(lu_ret.pdptSlot)) {
+            userError("X86EPTPageMap: Page directory already present.");
+            current_syscall_error.type = seL4_DeleteFirst;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        if ((ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) == ept_pdpte_ept_pdpte_1g) &&
+                ept_pdpte_ept_pdpte_1g_ptr_get_read(lu_ret.pdptSlot)) {
+            userError("X86EPTPageMap: Mapping already present.");
+            current_syscall_error.type = seL4_DeleteFirst;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        pdpte = ept_pdpte_ept_pdpte_1g_new(
+                    paddr,
+                    0,
+                    0,
+                    0,
+                    0,
+                    eptCacheFromVmAttr(vmAttr),
+                    1,
+                    WritableFromVMRights(vmRights),
+                    1);
+
+        setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        return performEPTPageMapPDPTE(cap, cte, lu_ret.pdptSlot, pdpte, pml4);
+    }
+#endif
+
     default:
-        /* When initializing EPT we only checked for support for 4K and 2M
-         * pages, so we must disallow attempting to use any other */
+        /* 1GiB pages are only available with huge page support, and we must
+         * disallow attempting to use any other page size */
         userError("X86EPTPageMap: Attempted to map unsupported page size.");
         current_syscall_error.type = seL4_InvalidCapability;
         current_syscall_error.invalidCapNumber = 0;
@@ -1022,7 +1328,7 @@ unmapEPTPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, void *pptr)
             return;
         }
 
-        *lu_ret.ptSlot = ept_pte_new(0, 0, 0, 0, 0, 0, 0);
+        *lu_ret.ptSlot = ept_pte_new(0, 0, 0, 0, 0, 0, 0, 0, 0);
         break;
     }
     case X86_LargePage: {
@@ -1042,17 +1348,39 @@ unmapEPTPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, void *pptr)
             return;
         }
 
-        lu_ret.pdSlot[0] = ept_pde_ept_pde_2m_new(0, 0, 0, 0, 0, 0, 0);
+        lu_ret.pdSlot[0] = ept_pde_ept_pde_2m_new(0, 0, 0, 0, 0, 0, 0, 0, 0);
 
         if (LARGE_PAGE_BITS != EPT_PD_INDEX_OFFSET) {
             assert(ept_pde_ptr_get_page_size(lu_ret.pdSlot + 1) == ept_pde_ept_pde_2m);
             assert(ept_pde_ept_pde_2m_ptr_get_read(lu_ret.pdSlot + 1));
             assert(ept_pde_ept_pde_2m_ptr_get_page_base_address(lu_ret.pdSlot + 1) == addr + BIT(21));
 
-            lu_ret.pdSlot[1] = ept_pde_ept_pde_2m_new(0, 0, 0, 0, 0, 0, 0);
+            lu_ret.pdSlot[1] = ept_pde_ept_pde_2m_new(0, 0, 0, 0, 0, 0, 0, 0, 0);
         }
         break;
     }
+#ifdef CONFIG_HUGE_PAGE
+    case X64_HugePage: {
+        lookupEPTPDPTSlot_ret_t lu_ret;
+
+        lu_ret = lookupEPTPDPTSlot(find_ret.ept, vptr);
+        if (lu_ret.status != EXCEPTION_NONE) {
+            return;
+        }
+        if (ept_pdpte_ptr_get_page_size(lu_ret.pdptSlot) != ept_pdpte_ept_pdpte_1g) {
+            return;
+        }
+        if (!ept_pdpte_ept_pdpte_1g_ptr_get_read(lu_ret.pdptSlot)) {
+            return;
+        }
+        if (ept_pdpte_ept_pdpte_1g_ptr_get_page_base_address(lu_ret.pdptSlot) != addr) {
+            return;
+        }
+
+        *lu_ret.pdptSlot = ept_pdpte_ept_pdpte_1g_new(0, 0, 0, 0, 0, 0, 0, 0, 0);
+        break;
+    }
+#endif
     default:
         /* we did not allow mapping additional page sizes into EPT objects,
          * so this should not happen. As we have no way to return an error
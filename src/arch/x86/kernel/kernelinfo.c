@@ -0,0 +1,91 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#include <config.h>
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+
+#include <kernel/boot.h>
+#include <model/statedata.h>
+#include <arch/machine.h>
+#include <arch/kernel/kernelinfo.h>
+
+compile_assert(kernel_info_fits_page, sizeof(seL4_KernelInfo) <= BIT(PAGE_BITS))
+compile_assert(kernel_info_node_is_cache_line, sizeof(seL4_KernelInfoNode) == L1_CACHE_LINE_SIZE)
+
+/* Readers may see the record change underneath them, the updates only need to
+ * be ordered with respect to seq, which on x86 only needs the compiler to
+ * respect program order */
+#define KERNEL_INFO_BARRIER asm volatile("" ::: "memory")
+
+BOOT_CODE bool_t
+x86_kernel_info_init(cap_t root_cnode_cap, seL4_BootInfo_KernelInfo_t *bi, uint32_t tsc_mhz)
+{
+    pptr_t pptr;
+    cap_t cap;
+
+    pptr = alloc_region(PAGE_BITS);
+    if (!pptr) {
+        printf("Kernel init failed: could not allocate kernel info page\n");
+        return false;
+    }
+    clearMemory((void*)pptr, PAGE_BITS);
+
+    x86KSkernelInfo = (seL4_KernelInfo*)pptr;
+    x86KSkernelInfo->numNodes = ksNumCPUs;
+    x86KSkernelInfo->timestampFreq = tsc_mhz;
+
+    /* user level must not be able to map it writable */
+    cap = create_unmapped_it_frame_cap(pptr, false);
+    cap = cap_frame_cap_set_capFVMRights(cap, wordFromVMRights(VMReadOnly));
+
+    bi->header.id = SEL4_BOOTINFO_HEADER_KERNEL_INFO;
+    bi->header.len = sizeof(*bi);
+    bi->frame = ndks_boot.slot_pos_cur;
+
+    return provide_cap(root_cnode_cap, cap);
+}
+
+/* Called on kernel entry from the idle thread */
+void
+x86_kernel_info_wake(void)
+{
+    seL4_KernelInfoNode *node = &x86KSkernelInfo->nodes[CURRENT_CPU_INDEX()];
+
+    node->seq++;
+    KERNEL_INFO_BARRIER;
+    node->idleTime += x86_rdtsc() - ARCH_NODE_STATE(x86KSkernelInfoIdleStart);
+    KERNEL_INFO_BARRIER;
+    node->seq++;
+}
+
+/* Called on every kernel exit to publish the state the core returns to user level with */
+void
+x86_kernel_info_exit(void)
+{
+    seL4_KernelInfoNode *node = &x86KSkernelInfo->nodes[CURRENT_CPU_INDEX()];
+    bool_t idle = NODE_STATE(ksCurThread) == NODE_STATE(ksIdleThread);
+
+    node->seq++;
+    KERNEL_INFO_BARRIER;
+    node->domain = ksCurDomain;
+    node->domainTime = ksDomainTime;
+    node->runnable = NODE_STATE(ksReadyThreads) + !idle;
+    if (idle) {
+        node->idleEntries++;
+        ARCH_NODE_STATE(x86KSkernelInfoIdleStart) = x86_rdtsc();
+    }
+    KERNEL_INFO_BARRIER;
+    node->seq++;
+}
+
+#endif /* CONFIG_KERNEL_INFO_PAGE */
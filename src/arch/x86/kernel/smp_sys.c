@@ -15,6 +15,7 @@
 #include <arch/kernel/boot_sys.h>
 #include <arch/kernel/smp_sys.h>
 #include <smp/lock.h>
+#include <benchmark/benchmark_boot.h>
 
 #ifdef ENABLE_SMP_SUPPORT
 
@@ -22,18 +23,22 @@
 BOOT_DATA VISIBLE
 volatile word_t smp_aps_index = 1;
 
+/* Number of APs that have finished booting */
+BOOT_DATA
+volatile word_t smp_aps_ready = 0;
+
 #ifdef CONFIG_USE_LOGICAL_IDS
 BOOT_CODE static void
 update_logical_id_mappings(void)
 {
-    cpu_mapping.index_to_logical_id[getCurrentCPUIndex()] = apic_get_logical_id();
-
-    for (int i = 0; i < smp_aps_index; i++) {
-        if (apic_get_cluster(cpu_mapping.index_to_logical_id[getCurrentCPUIndex()]) ==
-                apic_get_cluster(cpu_mapping.index_to_logical_id[i])) {
-
-            cpu_mapping.other_indexes_in_cluster[getCurrentCPUIndex()] |= BIT(i);
-            cpu_mapping.other_indexes_in_cluster[i] |= BIT(getCurrentCPUIndex());
+    for (word_t i = 0; i < boot_state.num_cpus; i++) {
+        for (word_t j = 0; j < i; j++) {
+            if (apic_get_cluster(cpu_mapping.index_to_logical_id[i]) ==
+                    apic_get_cluster(cpu_mapping.index_to_logical_id[j])) {
+
+                cpu_mapping.other_indexes_in_cluster[i] |= BIT(j);
+                cpu_mapping.other_indexes_in_cluster[j] |= BIT(i);
+            }
         }
     }
 }
@@ -59,7 +64,9 @@ start_boot_aps(void)
     cpu_mapping.index_to_logical_id[getCurrentCPUIndex()] = apic_get_logical_id();
 #endif /* CONFIG_USE_LOGICAL_IDS */
 
-    /* startup APs one at a time as we use shared kernel boot stack */
+    /* startup APs one at a time as they share the kernel boot stack, but only
+     * wait for each to move to its own kernel stack, and let the remainder of
+     * their initialisation run concurrently */
     while (smp_aps_index < boot_state.num_cpus) {
         word_t current_ap_index = smp_aps_index;
 
@@ -72,9 +79,16 @@ start_boot_aps(void)
         cpu_mapping.index_to_cpu_id[current_ap_index] = boot_state.cpus[current_ap_index];
         start_cpu(boot_state.cpus[current_ap_index], BOOT_NODE_PADDR);
 
-        /* wait for current AP to boot up */
+        /* wait for current AP to release the boot stack */
         while (smp_aps_index == current_ap_index);
     }
+
+    /* wait for all APs to finish booting */
+    while (smp_aps_ready < boot_state.num_cpus - 1);
+
+#ifdef CONFIG_USE_LOGICAL_IDS
+    update_logical_id_mappings();
+#endif /* CONFIG_USE_LOGICAL_IDS */
 }
 
 BOOT_CODE bool_t
@@ -118,7 +132,7 @@ try_boot_node(void)
     }
 
 #ifdef CONFIG_USE_LOGICAL_IDS
-    update_logical_id_mappings();
+    cpu_mapping.index_to_logical_id[getCurrentCPUIndex()] = apic_get_logical_id();
 #endif /* CONFIG_USE_LOGICAL_IDS */
     return true;
 }
@@ -127,18 +141,20 @@ try_boot_node(void)
  * there is a race between exiting this function and root task running on
  * node #0 to possibly reallocate this memory */
 VISIBLE void
-boot_node(void)
+boot_node(cpu_id_t cpu_index)
 {
     bool_t result;
 
-    mode_init_tls(smp_aps_index);
+    benchmark_boot_phase(cpu_index, seL4_BootPhase_Entry);
+    mode_init_tls(cpu_index);
     result = try_boot_node();
 
     if (!result) {
         fail("boot_node failed for some reason :(\n");
     }
+    benchmark_boot_phase(cpu_index, seL4_BootPhase_CPU);
 
-    smp_aps_index++;
+    __atomic_fetch_add(&smp_aps_ready, 1, __ATOMIC_RELEASE);
 
     /* grab BKL before leaving the kernel */
     NODE_LOCK_SYS;
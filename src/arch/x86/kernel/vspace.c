@@ -847,172 +847,257 @@ performX86PageInvocationUnmap(cap_t cap, cte_t *ctSlot)
     return EXCEPTION_NONE;
 }
 
-exception_t decodeX86FrameInvocation(
-    word_t invLabel,
-    word_t length,
-    cte_t* cte,
-    cap_t cap,
-    extra_caps_t excaps,
-    word_t* buffer
-)
+/* Map a frame into the given VSpace. restartCaller is false when this is done
+ * on behalf of another thread rather than as an invocation by the current one */
+exception_t
+decodeX86FrameMap(cap_t cap, cte_t *cte, cap_t vspaceCap, vptr_t vaddr, word_t w_rightsMask,
+                  vm_attributes_t vmAttr, bool_t restartCaller)
 {
-    switch (invLabel) {
-    case X86PageMap: { /* Map */
-        word_t          vaddr;
-        word_t          vtop;
-        word_t          w_rightsMask;
-        paddr_t         paddr;
-        cap_t           vspaceCap;
-        vspace_root_t*  vspace;
-        vm_rights_t     capVMRights;
-        vm_rights_t     vmRights;
-        vm_attributes_t vmAttr;
-        vm_page_size_t  frameSize;
-        asid_t          asid;
+    word_t          vtop;
+    paddr_t         paddr;
+    vspace_root_t*  vspace;
+    vm_rights_t     capVMRights;
+    vm_rights_t     vmRights;
+    vm_page_size_t  frameSize;
+    asid_t          asid;
 
-        if (length < 3 || excaps.excaprefs[0] == NULL) {
-            current_syscall_error.type = seL4_TruncatedMessage;
+    frameSize = cap_frame_cap_get_capFSize(cap);
 
-            return EXCEPTION_SYSCALL_ERROR;
-        }
+    capVMRights = cap_frame_cap_get_capFVMRights(cap);
 
-        frameSize = cap_frame_cap_get_capFSize(cap);
-        vaddr = getSyscallArg(0, buffer);
-        w_rightsMask = getSyscallArg(1, buffer);
-        vmAttr = vmAttributesFromWord(getSyscallArg(2, buffer));
-        vspaceCap = excaps.excaprefs[0]->cap;
+    if (cap_frame_cap_get_capFMappedASID(cap) != asidInvalid) {
+        userError("X86Frame: Frame already mapped.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
 
-        capVMRights = cap_frame_cap_get_capFVMRights(cap);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
 
-        if (cap_frame_cap_get_capFMappedASID(cap) != asidInvalid) {
-            userError("X86Frame: Frame already mapped.");
-            current_syscall_error.type = seL4_InvalidCapability;
-            current_syscall_error.invalidCapNumber = 0;
+    assert(cap_frame_cap_get_capFMapType(cap) == X86_MappingNone);
+
+    if (!isValidNativeRoot(vspaceCap)) {
+        userError("X86Frame: Attempting to map frame into invalid page directory cap.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 1;
+
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    vspace = (vspace_root_t*)pptr_of_cap(vspaceCap);
+    asid = cap_get_capMappedASID(vspaceCap);
+
+    {
+        findVSpaceForASID_ret_t find_ret;
+
+        find_ret = findVSpaceForASID(asid);
+        if (find_ret.status != EXCEPTION_NONE) {
+            current_syscall_error.type = seL4_FailedLookup;
+            current_syscall_error.failedLookupWasSource = false;
 
             return EXCEPTION_SYSCALL_ERROR;
         }
 
-        assert(cap_frame_cap_get_capFMapType(cap) == X86_MappingNone);
-
-        if (!isValidNativeRoot(vspaceCap)) {
-            userError("X86Frame: Attempting to map frame into invalid page directory cap.");
+        if (find_ret.vspace_root != vspace) {
             current_syscall_error.type = seL4_InvalidCapability;
             current_syscall_error.invalidCapNumber = 1;
 
             return EXCEPTION_SYSCALL_ERROR;
         }
-        vspace = (vspace_root_t*)pptr_of_cap(vspaceCap);
-        asid = cap_get_capMappedASID(vspaceCap);
+    }
 
-        {
-            findVSpaceForASID_ret_t find_ret;
+    vtop = vaddr + BIT(pageBitsForSize(frameSize));
 
-            find_ret = findVSpaceForASID(asid);
-            if (find_ret.status != EXCEPTION_NONE) {
-                current_syscall_error.type = seL4_FailedLookup;
-                current_syscall_error.failedLookupWasSource = false;
+    if (vtop > PPTR_USER_TOP) {
+        userError("X86Frame: Mapping address too high.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
 
-                return EXCEPTION_SYSCALL_ERROR;
-            }
+        return EXCEPTION_SYSCALL_ERROR;
+    }
 
-            if (find_ret.vspace_root != vspace) {
-                current_syscall_error.type = seL4_InvalidCapability;
-                current_syscall_error.invalidCapNumber = 1;
+    vmRights = maskVMRights(capVMRights, rightsFromWord(w_rightsMask));
 
-                return EXCEPTION_SYSCALL_ERROR;
-            }
-        }
+    if (!checkVPAlignment(frameSize, vaddr)) {
+        current_syscall_error.type = seL4_AlignmentError;
+
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    paddr = pptr_to_paddr((void*)cap_frame_cap_get_capFBasePtr(cap));
+
+    cap = cap_frame_cap_set_capFMappedASID(cap, asid);
+    cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr);
+    cap = cap_frame_cap_set_capFMapType(cap, X86_MappingVSpace);
 
-        vtop = vaddr + BIT(pageBitsForSize(frameSize));
+    switch (frameSize) {
+    /* PTE mappings */
+    case X86_SmallPage: {
+        pte_t              pte;
+        lookupPTSlot_ret_t lu_ret;
 
-        if (vtop > PPTR_USER_TOP) {
-            userError("X86Frame: Mapping address too high.");
-            current_syscall_error.type = seL4_InvalidArgument;
-            current_syscall_error.invalidArgumentNumber = 0;
+        lu_ret = lookupPTSlot(vspace, vaddr);
+        if (lu_ret.status != EXCEPTION_NONE) {
+            current_syscall_error.type = seL4_FailedLookup;
+            current_syscall_error.failedLookupWasSource = false;
+            /* current_lookup_fault will have been set by lookupPTSlot */
+            return EXCEPTION_SYSCALL_ERROR;
+        }
 
+        if (pte_ptr_get_present(lu_ret.ptSlot)) {
+            current_syscall_error.type = seL4_DeleteFirst;
             return EXCEPTION_SYSCALL_ERROR;
         }
 
-        vmRights = maskVMRights(capVMRights, rightsFromWord(w_rightsMask));
+        pte = makeUserPTE(paddr, vmAttr, vmRights);
+        if (restartCaller) {
+            setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        }
+        return performX86PageInvocationMapPTE(cap, cte, lu_ret.ptSlot, pte, vspace);
+    }
 
-        if (!checkVPAlignment(frameSize, vaddr)) {
-            current_syscall_error.type = seL4_AlignmentError;
+    /* PDE mappings */
+    case X86_LargePage: {
+        pde_t* pdeSlot;
+        pde_t  pde;
+        lookupPDSlot_ret_t lu_ret;
 
+        lu_ret = lookupPDSlot(vspace, vaddr);
+        if (lu_ret.status != EXCEPTION_NONE) {
+            current_syscall_error.type = seL4_FailedLookup;
+            current_syscall_error.failedLookupWasSource = false;
+            /* current_lookup_fault will have been set by lookupPDSlot */
             return EXCEPTION_SYSCALL_ERROR;
         }
+        pdeSlot = lu_ret.pdSlot;
 
-        paddr = pptr_to_paddr((void*)cap_frame_cap_get_capFBasePtr(cap));
-
-        cap = cap_frame_cap_set_capFMappedASID(cap, asid);
-        cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr);
-        cap = cap_frame_cap_set_capFMapType(cap, X86_MappingVSpace);
+        /* check for existing page table */
+        if ((pde_ptr_get_page_size(pdeSlot) == pde_pde_pt) &&
+                (pde_pde_pt_ptr_get_present(pdeSlot))) {
+            current_syscall_error.type = seL4_DeleteFirst;
 
-        switch (frameSize) {
-        /* PTE mappings */
-        case X86_SmallPage: {
-            pte_t              pte;
-            lookupPTSlot_ret_t lu_ret;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
 
-            lu_ret = lookupPTSlot(vspace, vaddr);
-            if (lu_ret.status != EXCEPTION_NONE) {
-                current_syscall_error.type = seL4_FailedLookup;
-                current_syscall_error.failedLookupWasSource = false;
-                /* current_lookup_fault will have been set by lookupPTSlot */
-                return EXCEPTION_SYSCALL_ERROR;
-            }
+        /* check for existing large page */
+        if ((pde_ptr_get_page_size(pdeSlot) == pde_pde_large) &&
+                (pde_pde_large_ptr_get_present(pdeSlot))) {
+            current_syscall_error.type = seL4_DeleteFirst;
 
-            if (pte_ptr_get_present(lu_ret.ptSlot)) {
-                current_syscall_error.type = seL4_DeleteFirst;
-                return EXCEPTION_SYSCALL_ERROR;
-            }
+            return EXCEPTION_SYSCALL_ERROR;
+        }
 
-            pte = makeUserPTE(paddr, vmAttr, vmRights);
+        pde = makeUserPDELargePage(paddr, vmAttr, vmRights);
+        if (restartCaller) {
             setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
-            return performX86PageInvocationMapPTE(cap, cte, lu_ret.ptSlot, pte, vspace);
         }
+        return performX86PageInvocationMapPDE(cap, cte, lu_ret.pdSlot, pde, vspace);
+    }
 
-        /* PDE mappings */
-        case X86_LargePage: {
-            pde_t* pdeSlot;
-            pde_t  pde;
-            lookupPDSlot_ret_t lu_ret;
+    default: {
+        return decodeX86ModeMapRemapPage(X86PageMap, frameSize, cte, cap, vspace, vaddr, paddr, vmRights, vmAttr, restartCaller);
+    }
+    }
 
-            lu_ret = lookupPDSlot(vspace, vaddr);
-            if (lu_ret.status != EXCEPTION_NONE) {
-                current_syscall_error.type = seL4_FailedLookup;
-                current_syscall_error.failedLookupWasSource = false;
-                /* current_lookup_fault will have been set by lookupPDSlot */
-                return EXCEPTION_SYSCALL_ERROR;
-            }
-            pdeSlot = lu_ret.pdSlot;
+    return EXCEPTION_SYSCALL_ERROR;
+}
 
-            /* check for existing page table */
-            if ((pde_ptr_get_page_size(pdeSlot) == pde_pde_pt) &&
-                    (pde_pde_pt_ptr_get_present(pdeSlot))) {
-                current_syscall_error.type = seL4_DeleteFirst;
+#ifdef CONFIG_X86_FAULT_REPLY_MAP
+compile_assert(vm_fault_reply_in_registers, (word_t)seL4_VMFaultReply_Length <= (word_t)n_msgRegisters)
 
-                return EXCEPTION_SYSCALL_ERROR;
-            }
+/* Map the frame given with the reply to a VM fault at the faulting address of
+ * the receiver, in the VSpace given as the second extra cap. Any failure
+ * leaves the VSpace unchanged and is flagged in the VM fault the restarted
+ * thread raises next */
+void
+handleVMFaultReplyMap(tcb_t *receiver, tcb_t *sender)
+{
+    seL4_MessageInfo_t tag = messageInfoFromWord(getRegister(sender, msgInfoRegister));
+    cte_t *frameSlot;
+    cap_t vspaceCap;
+    cap_t threadRoot;
+    vm_page_size_t frameSize;
+    vptr_t vaddr;
+    exception_t status;
+
+    if (seL4_MessageInfo_get_extraCaps(tag) == 0) {
+        return;
+    }
 
-            /* check for existing large page */
-            if ((pde_ptr_get_page_size(pdeSlot) == pde_pde_large) &&
-                    (pde_pde_large_ptr_get_present(pdeSlot))) {
-                current_syscall_error.type = seL4_DeleteFirst;
+    receiver->tcbArch.tcbVMFaultReplyMapFailed = true;
 
-                return EXCEPTION_SYSCALL_ERROR;
-            }
+    if (seL4_MessageInfo_get_length(tag) < seL4_VMFaultReply_Length) {
+        userError("VMFault reply: Truncated message.");
+        return;
+    }
 
-            pde = makeUserPDELargePage(paddr, vmAttr, vmRights);
-            setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
-            return performX86PageInvocationMapPDE(cap, cte, lu_ret.pdSlot, pde, vspace);
-        }
+    status = lookupExtraCaps(sender, lookupIPCBuffer(false, sender), tag);
+    if (status != EXCEPTION_NONE || current_extra_caps.excaprefs[0] == NULL
+            || current_extra_caps.excaprefs[1] == NULL) {
+        userError("VMFault reply: Failed to look up the frame and VSpace caps.");
+        return;
+    }
 
-        default: {
-            return decodeX86ModeMapRemapPage(invLabel, frameSize, cte, cap, vspace, vaddr, paddr, vmRights, vmAttr);
-        }
+    frameSlot = current_extra_caps.excaprefs[0];
+    if (cap_get_capType(frameSlot->cap) != cap_frame_cap) {
+        userError("VMFault reply: First extra cap is not a frame cap.");
+        return;
+    }
+
+    /* the VSpace cap grants the authority to map, but only into the VSpace
+     * the receiver faulted in */
+    vspaceCap = current_extra_caps.excaprefs[1]->cap;
+    threadRoot = TCB_PTR_CTE_PTR(receiver, tcbVTable)->cap;
+    if (!isValidNativeRoot(vspaceCap) || !isValidNativeRoot(threadRoot)
+            || pptr_of_cap(vspaceCap) != pptr_of_cap(threadRoot)) {
+        userError("VMFault reply: Second extra cap is not the VSpace of the faulting thread.");
+        return;
+    }
+
+    frameSize = cap_frame_cap_get_capFSize(frameSlot->cap);
+    vaddr = seL4_Fault_VMFault_get_address(receiver->tcbFault) & ~MASK(pageBitsForSize(frameSize));
+
+    /* the sender is replying rather than invoking the frame, so its thread
+     * state is left to the reply path */
+    status = decodeX86FrameMap(frameSlot->cap, frameSlot, vspaceCap, vaddr,
+                               getRegister(sender, msgRegisters[seL4_VMFaultReply_Rights]),
+                               vmAttributesFromWord(getRegister(sender, msgRegisters[seL4_VMFaultReply_Attributes])),
+                               false);
+    if (status != EXCEPTION_NONE) {
+        userError("VMFault reply: Failed to map frame at %p.", (void*)vaddr);
+        return;
+    }
+
+    receiver->tcbArch.tcbVMFaultReplyMapFailed = false;
+}
+#endif /* CONFIG_X86_FAULT_REPLY_MAP */
+
+exception_t decodeX86FrameInvocation(
+    word_t invLabel,
+    word_t length,
+    cte_t* cte,
+    cap_t cap,
+    extra_caps_t excaps,
+    word_t* buffer
+)
+{
+    switch (invLabel) {
+    case X86PageMap: { /* Map */
+        word_t          vaddr;
+        word_t          w_rightsMask;
+        cap_t           vspaceCap;
+        vm_attributes_t vmAttr;
+
+        if (length < 3 || excaps.excaprefs[0] == NULL) {
+            current_syscall_error.type = seL4_TruncatedMessage;
+
+            return EXCEPTION_SYSCALL_ERROR;
         }
 
-        return EXCEPTION_SYSCALL_ERROR;
+        vaddr = getSyscallArg(0, buffer);
+        w_rightsMask = getSyscallArg(1, buffer);
+        vmAttr = vmAttributesFromWord(getSyscallArg(2, buffer));
+        vspaceCap = excaps.excaprefs[0]->cap;
+
+        return decodeX86FrameMap(cap, cte, vspaceCap, vaddr, w_rightsMask, vmAttr, true);
     }
 
     case X86PageRemap: { /* Remap */
@@ -1139,7 +1224,7 @@ exception_t decodeX86FrameInvocation(
         }
 
         default: {
-            return decodeX86ModeMapRemapPage(invLabel, frameSize, cte, cap, vspace, vaddr, paddr, vmRights, vmAttr);
+            return decodeX86ModeMapRemapPage(invLabel, frameSize, cte, cap, vspace, vaddr, paddr, vmRights, vmAttr, true);
         }
         }
 
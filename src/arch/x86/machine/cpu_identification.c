@@ -119,6 +119,69 @@ x86_cpuid_amd_identity_initialize(cpu_identity_t *ci,
     }
 }
 
+/* Number of bits needed to hold a field of the APIC ID with count values */
+BOOT_CODE static uint32_t
+x86_cpuid_topology_width(uint32_t count)
+{
+    uint32_t width = 0;
+
+    while (BIT(width) < count) {
+        width++;
+    }
+    return width;
+}
+
+/* Number of cores in a package, from the deterministic cache parameters leaf
+ * on Intel or the extended size identifiers leaf on AMD. Without either every
+ * logical processor is taken to be a core of its own */
+BOOT_CODE static uint32_t
+x86_cpuid_topology_cores(uint32_t logical)
+{
+    if (x86_cpuid_eax(0, 0) >= 4 && (x86_cpuid_eax(4, 0) & MASK(5)) != 0) {
+        return ((x86_cpuid_eax(4, 0) >> 26) & MASK(6)) + 1;
+    } else if (x86_cpuid_eax(0x80000000, 0) >= 0x80000008) {
+        return (x86_cpuid_ecx(0x80000008, 0) & MASK(8)) + 1;
+    }
+    return logical;
+}
+
+/* Find how the APIC ID is split between package, core and SMT thread, using
+ * the extended topology leaf if it exists, or else the number of logical
+ * processors and cores per package */
+BOOT_CODE static void
+x86_cpuid_topology_initialize(cpu_identity_t *ci)
+{
+    uint32_t level, type, shift;
+
+    ci->smt_shift = 0;
+    ci->core_shift = 0;
+
+    if (x86_cpuid_eax(0, 0) >= 0xb && x86_cpuid_ebx(0xb, 0) != 0) {
+        for (level = 0; level < 0xff; level++) {
+            type = (x86_cpuid_ecx(0xb, level) >> 8) & MASK(8);
+            shift = x86_cpuid_eax(0xb, level) & MASK(5);
+            if (type == 0) {
+                break;
+            } else if (type == 1) {
+                ci->smt_shift = shift;
+            } else if (type == 2) {
+                ci->core_shift = shift;
+            }
+        }
+        if (ci->core_shift < ci->smt_shift) {
+            ci->core_shift = ci->smt_shift;
+        }
+    } else if (x86_cpuid_edx(1, 0) & BIT(28)) {
+        uint32_t logical = (x86_cpuid_ebx(1, 0) >> 16) & MASK(8);
+        uint32_t cores = x86_cpuid_topology_cores(logical);
+
+        if (cores != 0 && cores < logical) {
+            ci->smt_shift = x86_cpuid_topology_width(logical / cores);
+        }
+        ci->core_shift = x86_cpuid_topology_width(logical);
+    }
+}
+
 bool_t
 x86_cpuid_initialize(void)
 {
@@ -131,6 +194,7 @@ x86_cpuid_initialize(void)
 
     /* First determine which vendor manufactured the CPU. */
     x86_cpuid_fill_vendor_string(ci);
+    x86_cpuid_topology_initialize(ci);
 
     /* Need both eax and ebx ouput values. */
     eax.words[0] = x86_cpuid_eax(1, 0);
@@ -23,6 +23,28 @@ Arch_initFpuContext(user_context_t *context)
     context->fpuState = x86KSnullFpuState;
 }
 
+/*
+ * Size of the compacted XSAVE area used by XSAVEC and XSAVES for the given
+ * state components. Each component follows the previous enabled one, aligned
+ * to 64 bytes if CPUID reports that it requires it.
+ */
+static BOOT_CODE uint32_t
+xsave_compacted_size(uint64_t features)
+{
+    uint32_t size = sizeof(xsave_state_t);
+    int i;
+
+    for (i = 2; i < 64; i++) {
+        if (features & (1ull << i)) {
+            if (x86_cpuid_ecx(0x0d, i) & BIT(1)) {
+                size = ROUND_UP(size, 6);
+            }
+            size += x86_cpuid_eax(0x0d, i);
+        }
+    }
+    return size;
+}
+
 /*
  * Initialise the FPU for this machine.
  */
@@ -41,13 +63,13 @@ Arch_initFpu(void)
 
     if (config_set(CONFIG_XSAVE)) {
         uint64_t xsave_features;
+        uint64_t xss_features = 0;
         uint32_t xsave_instruction;
+        uint32_t xsave_size;
         uint64_t desired_features = config_ternary(CONFIG_XSAVE, CONFIG_XSAVE_FEATURE_SET, 1);
+        bool_t compacted = config_set(CONFIG_XSAVE_XSAVEC) || config_set(CONFIG_XSAVE_XSAVES);
         xsave_state_t *nullFpuState = (xsave_state_t *) &x86KSnullFpuState;
 
-        /* create NULL state for FPU to be used by XSAVE variants */
-        memzero(&x86KSnullFpuState, sizeof(x86KSnullFpuState));
-
         /* check for XSAVE support */
         if (!(x86_cpuid_ecx(1, 0) & BIT(26))) {
             printf("XSAVE not supported\n");
@@ -55,24 +77,6 @@ Arch_initFpu(void)
         }
         /* enable XSAVE support */
         write_cr4(read_cr4() | CR4_OSXSAVE);
-        /* check feature mask */
-        xsave_features = ((uint64_t)x86_cpuid_edx(0x0d, 0x0) << 32) | x86_cpuid_eax(0x0d, 0x0);
-        if ((xsave_features & desired_features) != desired_features) {
-            printf("Requested feature mask is 0x%llx, but only 0x%llx supported\n", desired_features, (long long)xsave_features);
-            return false;
-        }
-        /* enable feature mask */
-        write_xcr0(desired_features);
-        /* validate the xsave buffer size and instruction */
-        if (x86_cpuid_ebx(0x0d, 0x0) > CONFIG_XSAVE_SIZE) {
-            printf("XSAVE buffer set set to %d, but needs to be at least %d\n", CONFIG_XSAVE_SIZE, x86_cpuid_ebx(0x0d, 0x0));
-            return false;
-        }
-        if (x86_cpuid_ebx(0x0d, 0x0) < CONFIG_XSAVE_SIZE) {
-            printf("XSAVE buffer set set to %d, but only needs to be %d.\n"
-                   "Warning: Memory may be wasted with larger than needed TCBs.\n",
-                   CONFIG_XSAVE_SIZE, x86_cpuid_ebx(0x0d, 0x0));
-        }
         /* check if a specialized XSAVE instruction was requested */
         xsave_instruction = x86_cpuid_eax(0x0d, 0x1);
         if (config_set(CONFIG_XSAVE_XSAVEOPT)) {
@@ -90,18 +94,49 @@ Arch_initFpu(void)
                 printf("XSAVES requested, but not supported\n");
                 return false;
             }
-
-            /* AVX state from extended region should be in compacted format */
-            nullFpuState->header.xcomp_bv = XCOMP_BV_COMPACTED_FORMAT;
-
-            /* initialize the XSS MSR */
-            x86_wrmsr(IA32_XSS_MSR, desired_features);
+            /* supervisor state components can only be managed by XSAVES */
+            xss_features = ((uint64_t)x86_cpuid_edx(0x0d, 0x1) << 32) | x86_cpuid_ecx(0x0d, 0x1);
+        }
+        /* check feature mask */
+        xsave_features = ((uint64_t)x86_cpuid_edx(0x0d, 0x0) << 32) | x86_cpuid_eax(0x0d, 0x0);
+        if ((desired_features & (xsave_features | xss_features)) != desired_features) {
+            printf("Requested feature mask is 0x%llx, but only 0x%llx supported\n", desired_features,
+                   (long long)(xsave_features | xss_features));
+            return false;
+        }
+        /* enable feature mask, split between user components in XCR0 and
+         * supervisor components in the XSS MSR */
+        write_xcr0(desired_features & xsave_features);
+        if (config_set(CONFIG_XSAVE_XSAVES)) {
+            x86_wrmsr(IA32_XSS_MSR, desired_features & xss_features);
         }
+        /* validate the xsave buffer size. The compacted format only stores the
+         * enabled components, so AVX-512 state does not leave space for MPX */
+        xsave_size = compacted ? xsave_compacted_size(desired_features) : x86_cpuid_ebx(0x0d, 0x0);
+        if (xsave_size > CONFIG_XSAVE_SIZE) {
+            printf("XSAVE buffer set set to %d, but needs to be at least %d\n", CONFIG_XSAVE_SIZE, xsave_size);
+            return false;
+        }
+        if (xsave_size < CONFIG_XSAVE_SIZE) {
+            printf("XSAVE buffer set set to %d, but only needs to be %d.\n"
+                   "Warning: Memory may be wasted with larger than needed TCBs.\n",
+                   CONFIG_XSAVE_SIZE, xsave_size);
+        }
+        /* create NULL state for FPU to be used by XSAVE variants. This is
+         * shared by all cores, so only the BSP creates it as the APs boot
+         * concurrently */
+        if (SMP_TERNARY(getCurrentCPUIndex(), 0) == 0) {
+            memzero(&x86KSnullFpuState, sizeof(x86KSnullFpuState));
+            if (compacted) {
+                /* extended state components are stored in compacted format */
+                nullFpuState->header.xcomp_bv = XCOMP_BV_COMPACTED_FORMAT | desired_features;
+            }
 
-        /* copy i387 FPU initial state from FPU */
-        saveFpuState(&x86KSnullFpuState);
-        nullFpuState->i387.mxcsr = MXCSR_INIT_VALUE;
-    } else {
+            /* copy i387 FPU initial state from FPU */
+            saveFpuState(&x86KSnullFpuState);
+            nullFpuState->i387.mxcsr = MXCSR_INIT_VALUE;
+        }
+    } else if (SMP_TERNARY(getCurrentCPUIndex(), 0) == 0) {
         /* Store the null fpu state */
         saveFpuState(&x86KSnullFpuState);
     }
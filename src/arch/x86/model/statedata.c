@@ -35,6 +35,23 @@ UP_STATE_DEFINE(word_t, x86KSCurrentGSBase);
 
 UP_STATE_DEFINE(word_t, x86KSGPExceptReturnTo);
 
+#ifdef CONFIG_X86_IDLE_MWAIT
+UP_STATE_DEFINE(uint64_t, x86KSidleEnterTime);
+UP_STATE_DEFINE(uint64_t, x86KSidlePredicted);
+UP_STATE_DEFINE(word_t, x86KSidleState);
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+UP_STATE_DEFINE(uint64_t, x86KSidleWakeRequest);
+UP_STATE_DEFINE(x86_idle_stats_t, x86KSidleStats);
+#endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
+
+/* Cache line monitored by the idle thread while in MWAIT */
+word_t x86KSidleMonitorLine ALIGN(L1_CACHE_LINE_SIZE);
+#endif /* CONFIG_X86_IDLE_MWAIT */
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+UP_STATE_DEFINE(uint64_t, x86KSkernelInfoIdleStart);
+#endif
+
 /* ==== read-only kernel state (only written during bootstrapping) ==== */
 
 /* Defines a translation of cpu ids from an index of our actual CPUs */
@@ -46,6 +63,19 @@ uint32_t x86KScacheLineSizeBits;
 /* A valid initial FPU state, copied to every new thread. */
 user_fpu_state_t x86KSnullFpuState ALIGN(MIN_FPU_ALIGNMENT);
 
+#ifdef CONFIG_X86_IDLE_MWAIT
+/* C-states available to the idle governor, from shallowest to deepest */
+x86_idle_state_t x86KSidleStates[X86_IDLE_MAX_STATES];
+word_t x86KSidleNumStates;
+/* TSC cycles per tick of the APIC timer */
+word_t x86KSidleTscPerApicTick;
+#endif
+
+#ifdef CONFIG_KERNEL_INFO_PAGE
+/* Page exported read-only to user level, see seL4_KernelInfo */
+seL4_KernelInfo *x86KSkernelInfo;
+#endif
+
 /* Number of IOMMUs (DMA Remapping Hardware Units) */
 uint32_t x86KSnumDrhu;
 
@@ -25,6 +25,9 @@
 #include <arch/object/vcpu.h>
 #include <util.h>
 #include <arch/api/vmenter.h>
+#include <arch/kernel/apic.h>
+#include <arch/model/smp.h>
+#include <benchmark/benchmark_track.h>
 
 #define VMX_EXIT_QUAL_TYPE_MOV_CR 0
 #define VMX_EXIT_QUAL_TYPE_CLTS 2
@@ -32,6 +35,28 @@
 
 #define VMXON_REGION_SIZE 4096
 
+/* Controls needed for APIC virtualisation and posted interrupts */
+#define VMX_PIN_POSTED_INTERRUPTS BIT(7)
+#define VMX_PRIMARY_TPR_SHADOW BIT(21)
+#define VMX_SECONDARY_VIRTUALIZE_X2APIC BIT(4)
+#define VMX_SECONDARY_APIC_REGISTER_VIRT BIT(8)
+#define VMX_SECONDARY_VIRTUAL_INTR_DELIVERY BIT(9)
+#define VMX_SECONDARY_VIRTUAL_APIC (VMX_SECONDARY_VIRTUALIZE_X2APIC | \
+                                    VMX_SECONDARY_APIC_REGISTER_VIRT | \
+                                    VMX_SECONDARY_VIRTUAL_INTR_DELIVERY)
+
+/* x2APIC MSRs as seen by the guest. Reads of the whole range and writes to the
+ * TPR, EOI and self IPI registers are virtualised by the hardware */
+#define X2APIC_MSR_FIRST 0x800
+#define X2APIC_MSR_LAST 0x8FF
+#define X2APIC_MSR_TPR 0x808
+#define X2APIC_MSR_EOI 0x80B
+#define X2APIC_MSR_SELF_IPI 0x83F
+
+/* Guest interrupt vectors that can be posted. Vectors below 16 are reserved */
+#define VCPU_POSTED_VECTOR_MIN 16
+#define VCPU_POSTED_VECTOR_MAX 255
+
 const vcpu_gp_register_t crExitRegs[] = {
     VCPU_EAX, VCPU_ECX, VCPU_EDX, VCPU_EBX, VCPU_ESP, VCPU_EBP, VCPU_ESI, VCPU_EDI
 };
@@ -47,13 +72,18 @@ typedef struct msr_bitmaps {
     msr_bitmap_t high_msr_write;
 } msr_bitmaps_t;
 
+/* Each core needs its own VMXON region */
 static struct PACKED {
     uint32_t revision;
     char data[VMXON_REGION_SIZE - sizeof(uint32_t)];
-} vmxon_region ALIGN(VMXON_REGION_SIZE);
+} vmxon_region[CONFIG_MAX_NUM_NODES] ALIGN(VMXON_REGION_SIZE);
 
 static msr_bitmaps_t msr_bitmap_region ALIGN(BIT(seL4_PageBits));
 
+/* MSR bitmap for VCPUs with APIC virtualisation enabled, which additionally
+ * passes the virtualised x2APIC MSRs through to the hardware */
+static msr_bitmaps_t msr_bitmap_virtual_apic_region ALIGN(BIT(seL4_PageBits));
+
 static char null_ept_space[seL4_PageBits] ALIGN(BIT(seL4_PageBits));
 
 /* Cached value of the hardware defined vmcs revision */
@@ -84,6 +114,7 @@ static uint32_t cr4_low;
 static bool_t vmx_feature_vpid;
 static bool_t vmx_feature_load_perf_global_ctrl;
 static bool_t vmx_feature_ack_on_exit;
+static bool_t vmx_feature_virtual_apic;
 
 static vcpu_t *x86KSVPIDTable[VPID_LAST + 1];
 static vpid_t x86KSNextVPID = VPID_FIRST;
@@ -311,6 +342,18 @@ init_vtx_fixed_values(bool_t useTrueMsrs)
         exit_control_mask |= BIT(15);
     }
 
+    /* Check for APIC virtualisation with posted interrupts. These controls are
+     * only enabled on VCPUs that request them, so are not added to the masks */
+    if (!vmx_feature_ack_on_exit ||
+            !(pin_control_low & VMX_PIN_POSTED_INTERRUPTS) ||
+            !(primary_control_low & VMX_PRIMARY_TPR_SHADOW) ||
+            (secondary_control_low & VMX_SECONDARY_VIRTUAL_APIC) != VMX_SECONDARY_VIRTUAL_APIC) {
+        vmx_feature_virtual_apic = 0;
+        printf("vt-x: Posted interrupts not supported. Guest interrupts will require VM exits\n");
+    } else {
+        vmx_feature_virtual_apic = 1;
+    }
+
     /* See if the hardware requires bits that require to be high to be low */
     uint32_t missing;
     missing = (~pin_control_low) & pin_control_mask;
@@ -424,6 +467,10 @@ vcpu_init(vcpu_t *vcpu)
     vcpu->cr0_mask = 0;
     vcpu->exception_bitmap = 0;
     vcpu->vpid = VPID_INVALID;
+    memset(&vcpu->exit_policy, 0, sizeof(vcpu->exit_policy));
+    vcpu->exit_snapshot_count = 0;
+    vcpu->virtual_apic_enabled = false;
+    vcpu->posted_badge_mask = 0;
 #ifdef ENABLE_SMP_SUPPORT
     vcpu->last_cpu = getCurrentCPUIndex();
 #endif /* ENABLE_SMP_SUPPORT */
@@ -654,14 +701,32 @@ decodeDisableIOPort(cap_t cap, word_t length, word_t* buffer)
     return invokeDisableIOPort(vcpu, low, high);
 }
 
-static exception_t
-invokeWriteVMCS(vcpu_t *vcpu, word_t *buffer, word_t field, word_t value)
+/* Forces on the controls needed by APIC virtualisation if the VCPU has it
+ * enabled, as the virtual-APIC state would otherwise be silently ignored */
+static word_t
+applyVirtualAPICControls(vcpu_t *vcpu, word_t field, word_t value)
+{
+    if (!vcpu->virtual_apic_enabled) {
+        return value;
+    }
+    switch (field) {
+    case VMX_CONTROL_PIN_EXECUTION_CONTROLS:
+        return value | VMX_PIN_POSTED_INTERRUPTS;
+    case VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS:
+        return value | VMX_PRIMARY_TPR_SHADOW;
+    case VMX_CONTROL_SECONDARY_PROCESSOR_CONTROLS:
+        return value | VMX_SECONDARY_VIRTUAL_APIC;
+    }
+    return value;
+}
+
+static void
+writeVMCSField(vcpu_t *vcpu, word_t field, word_t value)
 {
-    tcb_t *thread;
-    thread = NODE_STATE(ksCurThread);
     if (ARCH_NODE_STATE(x86KSCurrentVCPU) != vcpu) {
         switchVCPU(vcpu);
     }
+    value = applyVirtualAPICControls(vcpu, field, value);
     switch (field) {
     case VMX_CONTROL_EXCEPTION_BITMAP:
         vcpu->exception_bitmap = vcpu->cached_exception_bitmap = value;
@@ -676,26 +741,32 @@ invokeWriteVMCS(vcpu_t *vcpu, word_t *buffer, word_t field, word_t value)
         vcpu->cr0_shadow = vcpu->cached_cr0_shadow = value;
         break;
     }
-    setMR(thread, buffer, 0, value);
     vmwrite(field, value);
-    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
-    return EXCEPTION_NONE;
 }
 
 static exception_t
-decodeWriteVMCS(cap_t cap, word_t length, word_t* buffer)
+invokeWriteVMCS(vcpu_t *vcpu, word_t *buffer, word_t field, word_t value)
 {
-    word_t field;
+    tcb_t *thread;
+    thread = NODE_STATE(ksCurThread);
+    writeVMCSField(vcpu, field, value);
+    setMR(thread, buffer, 0, value);
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+typedef struct decodeWriteVMCSField_ret {
+    exception_t status;
     word_t value;
+} decodeWriteVMCSField_ret_t;
 
-    if (length < 2) {
-        userError("VCPU WriteVMCS: Not enough arguments.");
-        current_syscall_error.type = seL4_IllegalOperation;
-        return EXCEPTION_SYSCALL_ERROR;
-    }
+/* Checks that the given field can be written by the VCPU owner and returns the
+ * value to write after forcing any bits that are fixed by the hardware */
+static decodeWriteVMCSField_ret_t
+decodeWriteVMCSField(word_t field, word_t value)
+{
+    decodeWriteVMCSField_ret_t ret;
 
-    field = getSyscallArg(0, buffer);
-    value = getSyscallArg(1, buffer);
     switch (field) {
     case VMX_GUEST_RIP:
     case VMX_GUEST_RSP:
@@ -760,6 +831,12 @@ decodeWriteVMCS(cap_t cap, word_t length, word_t* buffer)
     case VMX_GUEST_CR3:
     case VMX_CONTROL_EXCEPTION_BITMAP:
     case VMX_CONTROL_ENTRY_INTERRUPTION_INFO:
+    case VMX_GUEST_INTERRUPT_STATUS:
+    case VMX_CONTROL_TPR_THRESHOLD:
+    case VMX_CONTROL_EOI_EXIT_BITMAP0:
+    case VMX_CONTROL_EOI_EXIT_BITMAP1:
+    case VMX_CONTROL_EOI_EXIT_BITMAP2:
+    case VMX_CONTROL_EOI_EXIT_BITMAP3:
         break;
     case VMX_CONTROL_PIN_EXECUTION_CONTROLS:
         value = applyFixedBits(value, pin_control_high, pin_control_low);
@@ -782,9 +859,32 @@ decodeWriteVMCS(cap_t cap, word_t length, word_t* buffer)
     default:
         userError("VCPU WriteVMCS: Invalid field %lx.", (long)field);
         current_syscall_error.type = seL4_IllegalOperation;
+        ret.status = EXCEPTION_SYSCALL_ERROR;
+        return ret;
+    }
+    ret.status = EXCEPTION_NONE;
+    ret.value = value;
+    return ret;
+}
+
+static exception_t
+decodeWriteVMCS(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t field;
+    decodeWriteVMCSField_ret_t ret;
+
+    if (length < 2) {
+        userError("VCPU WriteVMCS: Not enough arguments.");
+        current_syscall_error.type = seL4_IllegalOperation;
         return EXCEPTION_SYSCALL_ERROR;
     }
-    return invokeWriteVMCS(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), buffer, field, value);
+
+    field = getSyscallArg(0, buffer);
+    ret = decodeWriteVMCSField(field, getSyscallArg(1, buffer));
+    if (ret.status != EXCEPTION_NONE) {
+        return ret.status;
+    }
+    return invokeWriteVMCS(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), buffer, field, ret.value);
 }
 
 static word_t readVMCSField(vcpu_t *vcpu, word_t field)
@@ -818,15 +918,10 @@ invokeReadVMCS(vcpu_t *vcpu, word_t field, word_t *buffer)
     return EXCEPTION_NONE;
 }
 
+/* Checks that the given field can be read by the VCPU owner */
 static exception_t
-decodeReadVMCS(cap_t cap, word_t length, word_t* buffer)
+decodeReadVMCSField(word_t field)
 {
-    if (length < 1) {
-        userError("VCPU ReadVMCS: Not enough arguments.");
-        current_syscall_error.type = seL4_IllegalOperation;
-        return EXCEPTION_SYSCALL_ERROR;
-    }
-    word_t field = getSyscallArg(0, buffer);
     switch (field) {
     case VMX_GUEST_RIP:
     case VMX_GUEST_RSP:
@@ -909,15 +1004,331 @@ decodeReadVMCS(cap_t cap, word_t length, word_t* buffer)
     case VMX_GUEST_CR0:
     case VMX_GUEST_CR3:
     case VMX_GUEST_CR4:
+    case VMX_GUEST_INTERRUPT_STATUS:
+    case VMX_CONTROL_TPR_THRESHOLD:
+    case VMX_CONTROL_EOI_EXIT_BITMAP0:
+    case VMX_CONTROL_EOI_EXIT_BITMAP1:
+    case VMX_CONTROL_EOI_EXIT_BITMAP2:
+    case VMX_CONTROL_EOI_EXIT_BITMAP3:
         break;
     default:
         userError("VCPU ReadVMCS: Invalid field %lx.", (long)field);
         current_syscall_error.type = seL4_IllegalOperation;
         return EXCEPTION_SYSCALL_ERROR;
     }
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeReadVMCS(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t field;
+    exception_t status;
+
+    if (length < 1) {
+        userError("VCPU ReadVMCS: Not enough arguments.");
+        current_syscall_error.type = seL4_IllegalOperation;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    field = getSyscallArg(0, buffer);
+    status = decodeReadVMCSField(field);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
     return invokeReadVMCS(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), field, buffer);
 }
 
+static exception_t
+decodeVMCSBatchCount(word_t count)
+{
+    if (count > SEL4_VMCS_BATCH_MAX_FIELDS) {
+        userError("VCPU: Invalid number of VMCS fields %ld.", (long)count);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = SEL4_VMCS_BATCH_MAX_FIELDS;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+invokeReadVMCSBatch(vcpu_t *vcpu, word_t count, word_t *buffer)
+{
+    tcb_t *thread;
+    word_t i;
+
+    thread = NODE_STATE(ksCurThread);
+
+    /* fields and results share message registers, but result i is written
+     * after field i has been read and never overwrites a later field */
+    for (i = 0; i < count; i++) {
+        setMR(thread, buffer, i, readVMCSField(vcpu, getSyscallArg(i + 1, buffer)));
+    }
+    setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                    seL4_MessageInfo_new(0, 0, 0, count)));
+    setThreadState(thread, ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeReadVMCSBatch(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    exception_t status;
+
+    if (length < 1 + SEL4_VMCS_BATCH_MAX_FIELDS) {
+        userError("VCPU ReadVMCSBatch: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    status = decodeVMCSBatchCount(count);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        status = decodeReadVMCSField(getSyscallArg(i + 1, buffer));
+        if (status != EXCEPTION_NONE) {
+            return status;
+        }
+    }
+
+    return invokeReadVMCSBatch(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, buffer);
+}
+
+static exception_t
+invokeWriteVMCSBatch(vcpu_t *vcpu, word_t count, word_t *fields, word_t *values, word_t *buffer)
+{
+    tcb_t *thread;
+    word_t i;
+
+    thread = NODE_STATE(ksCurThread);
+
+    for (i = 0; i < count; i++) {
+        writeVMCSField(vcpu, fields[i], values[i]);
+        setMR(thread, buffer, i, values[i]);
+    }
+    setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                    seL4_MessageInfo_new(0, 0, 0, count)));
+    setThreadState(thread, ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeWriteVMCSBatch(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    word_t fields[SEL4_VMCS_BATCH_MAX_FIELDS];
+    word_t values[SEL4_VMCS_BATCH_MAX_FIELDS];
+    exception_t status;
+    decodeWriteVMCSField_ret_t ret;
+
+    if (length < 1 + SEL4_VMCS_BATCH_MAX_FIELDS * 2) {
+        userError("VCPU WriteVMCSBatch: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    status = decodeVMCSBatchCount(count);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    /* validate every field before writing any of them so that a failed
+     * invocation leaves the VMCS untouched */
+    for (i = 0; i < count; i++) {
+        fields[i] = getSyscallArg(i + 1, buffer);
+        ret = decodeWriteVMCSField(fields[i],
+                                   getSyscallArg(i + 1 + SEL4_VMCS_BATCH_MAX_FIELDS, buffer));
+        if (ret.status != EXCEPTION_NONE) {
+            return ret.status;
+        }
+        values[i] = ret.value;
+    }
+
+    return invokeWriteVMCSBatch(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, fields, values, buffer);
+}
+
+static exception_t
+invokeSetExitSnapshot(vcpu_t *vcpu, word_t count, word_t *buffer)
+{
+    word_t i;
+
+    for (i = 0; i < count; i++) {
+        vcpu->exit_snapshot[i] = getSyscallArg(i + 1, buffer);
+    }
+    vcpu->exit_snapshot_count = count;
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeSetExitSnapshot(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t count;
+    word_t i;
+    exception_t status;
+
+    if (length < 1 + SEL4_VMCS_BATCH_MAX_FIELDS) {
+        userError("VCPU SetExitSnapshot: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    count = getSyscallArg(0, buffer);
+    status = decodeVMCSBatchCount(count);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        status = decodeReadVMCSField(getSyscallArg(i + 1, buffer));
+        if (status != EXCEPTION_NONE) {
+            return status;
+        }
+    }
+
+    return invokeSetExitSnapshot(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), count, buffer);
+}
+
+static exception_t
+decodeExitPolicyIndex(word_t index, word_t max)
+{
+    if (index >= max) {
+        userError("VCPU SetExitPolicy: Invalid index %ld.", (long)index);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = max - 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+invokeSetCPUIDExit(vcpu_t *vcpu, word_t index, vcpu_cpuid_exit_t entry)
+{
+    vcpu->exit_policy.cpuid[index] = entry;
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeSetCPUIDExit(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t index;
+    vcpu_cpuid_exit_t entry;
+    exception_t status;
+
+    if (length < 8) {
+        userError("VCPU SetCPUIDExit: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = getSyscallArg(0, buffer);
+    status = decodeExitPolicyIndex(index, SEL4_VMEXIT_POLICY_NUM_CPUID);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    entry.flags = getSyscallArg(1, buffer);
+    entry.leaf = getSyscallArg(2, buffer);
+    entry.subleaf = getSyscallArg(3, buffer);
+    entry.eax = getSyscallArg(4, buffer);
+    entry.ebx = getSyscallArg(5, buffer);
+    entry.ecx = getSyscallArg(6, buffer);
+    entry.edx = getSyscallArg(7, buffer);
+
+    return invokeSetCPUIDExit(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), index, entry);
+}
+
+static exception_t
+invokeSetMSRExit(vcpu_t *vcpu, word_t index, vcpu_msr_exit_t entry)
+{
+    vcpu->exit_policy.msr[index] = entry;
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeSetMSRExit(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t index;
+    vcpu_msr_exit_t entry;
+    exception_t status;
+
+    if (length < 5) {
+        userError("VCPU SetMSRExit: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = getSyscallArg(0, buffer);
+    status = decodeExitPolicyIndex(index, SEL4_VMEXIT_POLICY_NUM_MSR);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    entry.flags = getSyscallArg(1, buffer);
+    entry.msr = getSyscallArg(2, buffer);
+    /* the value is always passed as two 32-bit halves so that the invocation
+     * has the same layout on ia32 and x86_64 */
+    entry.value = ((uint64_t)(uint32_t)getSyscallArg(4, buffer) << 32) |
+                  (uint32_t)getSyscallArg(3, buffer);
+
+    if ((entry.flags & SEL4_VMEXIT_POLICY_ENABLE) &&
+            (entry.msr == IA32_SYSENTER_CS_MSR ||
+             entry.msr == IA32_SYSENTER_ESP_MSR ||
+             entry.msr == IA32_SYSENTER_EIP_MSR)) {
+        /* these are passed through to the guest and will never cause an exit */
+        userError("VCPU SetMSRExit: MSR %lx is not intercepted.", (long)entry.msr);
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 2;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    return invokeSetMSRExit(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), index, entry);
+}
+
+static exception_t
+invokeSetIOPortExit(vcpu_t *vcpu, word_t index, vcpu_io_exit_t entry)
+{
+    vcpu->exit_policy.io[index] = entry;
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeSetIOPortExit(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t index;
+    vcpu_io_exit_t entry;
+    exception_t status;
+
+    if (length < 4) {
+        userError("VCPU SetIOPortExit: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = getSyscallArg(0, buffer);
+    status = decodeExitPolicyIndex(index, SEL4_VMEXIT_POLICY_NUM_IOPORT);
+    if (status != EXCEPTION_NONE) {
+        return status;
+    }
+
+    entry.flags = getSyscallArg(1, buffer);
+    entry.port = getSyscallArg(2, buffer);
+    entry.value = getSyscallArg(3, buffer);
+
+    return invokeSetIOPortExit(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), index, entry);
+}
+
 static exception_t
 invokeSetTCB(vcpu_t *vcpu, tcb_t *tcb)
 {
@@ -947,6 +1358,171 @@ decodeSetTCB(cap_t cap, word_t length, word_t* buffer, extra_caps_t excaps)
     return invokeSetTCB(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), TCB_PTR(cap_thread_cap_get_capTCBPtr(tcbCap)));
 }
 
+static exception_t
+invokeEnableVirtualAPIC(vcpu_t *vcpu)
+{
+    if (ARCH_NODE_STATE(x86KSCurrentVCPU) != vcpu) {
+        switchVCPU(vcpu);
+    }
+    if (!vcpu->virtual_apic_enabled) {
+        memzero(vcpu->virtual_apic, sizeof(vcpu->virtual_apic));
+        memzero(&vcpu->pi_desc, sizeof(vcpu->pi_desc));
+        vcpu->pi_desc.control = (uint32_t)int_vtx_posted_interrupt << VCPU_PI_DESC_NV_SHIFT;
+
+        vmwrite(VMX_CONTROL_VIRTUAL_APIC_ADDRESS, pptr_to_paddr(vcpu->virtual_apic));
+        vmwrite(VMX_CONTROL_POSTED_INTERRUPT_DESC_ADDRESS, pptr_to_paddr(&vcpu->pi_desc));
+        vmwrite(VMX_CONTROL_POSTED_INTERRUPT_VECTOR, int_vtx_posted_interrupt);
+        vmwrite(VMX_CONTROL_TPR_THRESHOLD, 0);
+        vmwrite(VMX_GUEST_INTERRUPT_STATUS, 0);
+        vmwrite(VMX_CONTROL_EOI_EXIT_BITMAP0, 0);
+        vmwrite(VMX_CONTROL_EOI_EXIT_BITMAP1, 0);
+        vmwrite(VMX_CONTROL_EOI_EXIT_BITMAP2, 0);
+        vmwrite(VMX_CONTROL_EOI_EXIT_BITMAP3, 0);
+        vmwrite(VMX_CONTROL_MSR_ADDRESS, (word_t)kpptr_to_paddr(&msr_bitmap_virtual_apic_region));
+
+        vcpu->virtual_apic_enabled = true;
+        /* now that the VCPU is marked as enabled, rewriting the controls will
+         * force on the required bits */
+        writeVMCSField(vcpu, VMX_CONTROL_PIN_EXECUTION_CONTROLS,
+                       vmread(VMX_CONTROL_PIN_EXECUTION_CONTROLS));
+        writeVMCSField(vcpu, VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS,
+                       vmread(VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS));
+        writeVMCSField(vcpu, VMX_CONTROL_SECONDARY_PROCESSOR_CONTROLS,
+                       vmread(VMX_CONTROL_SECONDARY_PROCESSOR_CONTROLS));
+    }
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeEnableVirtualAPIC(cap_t cap)
+{
+    if (!vmx_feature_virtual_apic) {
+        userError("VCPU EnableVirtualAPIC: Posted interrupts not supported by hardware.");
+        current_syscall_error.type = seL4_IllegalOperation;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    return invokeEnableVirtualAPIC(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)));
+}
+
+static exception_t
+invokeSetPostedVector(vcpu_t *vcpu, word_t bit, word_t vector)
+{
+    if (vector == 0) {
+        vcpu->posted_badge_mask &= ~BIT(bit);
+    } else {
+        vcpu->posted_vector[bit] = vector;
+        vcpu->posted_badge_mask |= BIT(bit);
+    }
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeSetPostedVector(cap_t cap, word_t length, word_t* buffer)
+{
+    word_t bit;
+    word_t vector;
+
+    if (length < 2) {
+        userError("VCPU SetPostedVector: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    bit = getSyscallArg(0, buffer);
+    vector = getSyscallArg(1, buffer);
+
+    if (bit >= wordBits) {
+        userError("VCPU SetPostedVector: Invalid badge bit %ld.", (long)bit);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = wordBits - 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (vector != 0 && (vector < VCPU_POSTED_VECTOR_MIN || vector > VCPU_POSTED_VECTOR_MAX)) {
+        userError("VCPU SetPostedVector: Invalid vector %ld.", (long)vector);
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    return invokeSetPostedVector(VCPU_PTR(cap_vcpu_cap_get_capVCPUPtr(cap)), bit, vector);
+}
+
+word_t
+vcpu_post_notification(tcb_t *tcb, word_t badge)
+{
+    vcpu_t *vcpu = tcb->tcbArch.tcbVCPU;
+    word_t posted;
+    word_t pending;
+    uint32_t control;
+
+    if (!vcpu || !vcpu->virtual_apic_enabled) {
+        return badge;
+    }
+
+    posted = badge & vcpu->posted_badge_mask;
+    if (posted == 0) {
+        return badge;
+    }
+
+    pending = posted;
+    while (pending) {
+        word_t bit = wordBits - 1 - clzl(pending);
+        uint8_t vector = vcpu->posted_vector[bit];
+        /* the guest's core may be processing the descriptor concurrently */
+        __atomic_fetch_or(&vcpu->pi_desc.pir[vector / 32], (uint32_t)BIT(vector % 32), __ATOMIC_SEQ_CST);
+        pending &= ~BIT(bit);
+    }
+
+    control = __atomic_fetch_or(&vcpu->pi_desc.control, (uint32_t)VCPU_PI_DESC_ON, __ATOMIC_SEQ_CST);
+#ifdef ENABLE_SMP_SUPPORT
+    /* If a notification is not already outstanding and the guest may be running on
+     * another core, send the notification vector so that the hardware delivers the
+     * interrupts without a VM exit. If the guest is not running the interrupts are
+     * picked up when it is next entered */
+    if (!(control & VCPU_PI_DESC_ON) && tcb->tcbAffinity != getCurrentCPUIndex()) {
+        IPI_ICR_BARRIER;
+        ipi_send_target(int_vtx_posted_interrupt, cpuIndexToID(tcb->tcbAffinity));
+    }
+#else
+    (void)control;
+#endif /* ENABLE_SMP_SUPPORT */
+
+    return badge & ~posted;
+}
+
+/* Moves any interrupts that were posted whilst the guest was not running into the
+ * virtual APIC, as the hardware only processes the descriptor on a notification */
+static void
+syncPostedInterrupts(vcpu_t *vcpu)
+{
+    word_t i;
+    word_t max_vector = 0;
+    word_t status;
+
+    if (!(vcpu->pi_desc.control & VCPU_PI_DESC_ON)) {
+        return;
+    }
+    __atomic_fetch_and(&vcpu->pi_desc.control, ~(uint32_t)VCPU_PI_DESC_ON, __ATOMIC_SEQ_CST);
+
+    for (i = 0; i < ARRAY_SIZE(vcpu->pi_desc.pir); i++) {
+        uint32_t pir = __atomic_exchange_n(&vcpu->pi_desc.pir[i], 0, __ATOMIC_SEQ_CST);
+        if (pir) {
+            *(uint32_t*)(vcpu->virtual_apic + VCPU_VAPIC_IRR + i * 16) |= pir;
+            max_vector = i * 32 + wordBits - 1 - clzl(pir);
+        }
+    }
+
+    /* raise the requesting virtual interrupt to the highest vector posted */
+    status = vmread(VMX_GUEST_INTERRUPT_STATUS);
+    if (max_vector > (status & MASK(8))) {
+        vmwrite(VMX_GUEST_INTERRUPT_STATUS, (status & ~MASK(8)) | max_vector);
+    }
+}
+
 void
 vcpu_update_state_sysvmenter(vcpu_t *vcpu)
 {
@@ -960,7 +1536,9 @@ vcpu_update_state_sysvmenter(vcpu_t *vcpu)
         return;
     }
     vmwrite(VMX_GUEST_RIP, getSyscallArg(0, buffer));
-    vmwrite(VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS, applyFixedBits(getSyscallArg(1, buffer), primary_control_high, primary_control_low));
+    vmwrite(VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS,
+            applyVirtualAPICControls(vcpu, VMX_CONTROL_PRIMARY_PROCESSOR_CONTROLS,
+                                     applyFixedBits(getSyscallArg(1, buffer), primary_control_high, primary_control_low)));
     vmwrite(VMX_CONTROL_ENTRY_INTERRUPTION_INFO, getSyscallArg(2, buffer));
 }
 
@@ -1004,12 +1582,28 @@ decodeX86VCPUInvocation(
         return decodeReadVMCS(cap, length, buffer);
     case X86VCPUWriteVMCS:
         return decodeWriteVMCS(cap, length, buffer);
+    case X86VCPUReadVMCSBatch:
+        return decodeReadVMCSBatch(cap, length, buffer);
+    case X86VCPUWriteVMCSBatch:
+        return decodeWriteVMCSBatch(cap, length, buffer);
+    case X86VCPUSetExitSnapshot:
+        return decodeSetExitSnapshot(cap, length, buffer);
     case X86VCPUEnableIOPort:
         return decodeEnableIOPort(cap, length, buffer, excaps);
     case X86VCPUDisableIOPort:
         return decodeDisableIOPort(cap, length, buffer);
     case X86VCPUWriteRegisters:
         return decodeVCPUWriteRegisters(cap, length, buffer);
+    case X86VCPUSetCPUIDExit:
+        return decodeSetCPUIDExit(cap, length, buffer);
+    case X86VCPUSetMSRExit:
+        return decodeSetMSRExit(cap, length, buffer);
+    case X86VCPUSetIOPortExit:
+        return decodeSetIOPortExit(cap, length, buffer);
+    case X86VCPUEnableVirtualAPIC:
+        return decodeEnableVirtualAPIC(cap);
+    case X86VCPUSetPostedVector:
+        return decodeSetPostedVector(cap, length, buffer);
     default:
         userError("VCPU: Illegal operation.");
         current_syscall_error.type = seL4_IllegalOperation;
@@ -1033,9 +1627,35 @@ clear_bit(word_t *bitmap, word_t bit)
     bitmap[index] &= ~BIT(offset);
 }
 
+/* Initialise the MSR bitmaps shared by the VCPUs of all cores */
+static BOOT_CODE void
+init_vtx_msr_bitmaps(void)
+{
+    memset(&msr_bitmap_region, ~0, sizeof(msr_bitmap_region));
+    /* Set sysenter MSRs to writeable and readable. These are all low msrs */
+    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_CS_MSR);
+    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_ESP_MSR);
+    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_EIP_MSR);
+    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_CS_MSR);
+    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_ESP_MSR);
+    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_EIP_MSR);
+    if (vmx_feature_virtual_apic) {
+        word_t msr;
+        memcpy(&msr_bitmap_virtual_apic_region, &msr_bitmap_region, sizeof(msr_bitmap_region));
+        for (msr = X2APIC_MSR_FIRST; msr <= X2APIC_MSR_LAST; msr++) {
+            clear_bit(msr_bitmap_virtual_apic_region.low_msr_read.bitmap, msr);
+        }
+        clear_bit(msr_bitmap_virtual_apic_region.low_msr_write.bitmap, X2APIC_MSR_TPR);
+        clear_bit(msr_bitmap_virtual_apic_region.low_msr_write.bitmap, X2APIC_MSR_EOI);
+        clear_bit(msr_bitmap_virtual_apic_region.low_msr_write.bitmap, X2APIC_MSR_SELF_IPI);
+    }
+}
+
 BOOT_CODE bool_t
 vtx_init(void)
 {
+    word_t cpu = SMP_TERNARY(getCurrentCPUIndex(), 0);
+
     if (!is_vtx_supported()) {
         printf("vt-x: not supported\n");
         return false;
@@ -1044,7 +1664,6 @@ vtx_init(void)
     feature_control_msr_t feature_control;
     vmx_basic.words[0] = x86_rdmsr_low(IA32_VMX_BASIC_MSR);
     vmx_basic.words[1] = x86_rdmsr_high(IA32_VMX_BASIC_MSR);
-    vmcs_revision = vmx_basic_msr_get_vmcs_revision(vmx_basic);
     feature_control.words[0] = x86_rdmsr_low(IA32_FEATURE_CONTROL_MSR);
     if (!feature_control_msr_get_vmx_outside_smx(feature_control)) {
         /* enable if the MSR is not locked */
@@ -1060,54 +1679,51 @@ vtx_init(void)
         feature_control = feature_control_msr_set_lock(feature_control, 1);
         x86_wrmsr_parts(IA32_FEATURE_CONTROL_MSR, x86_rdmsr_high(IA32_FEATURE_CONTROL_MSR), feature_control.words[0]);
     }
-    /* Initialize the fixed values only on the boot core. All other cores
-     * will just check that the fixed values are valid */
-    if (SMP_TERNARY(getCurrentCPUIndex(), 0) == 0) {
+    /* Initialize the fixed values and the state shared between cores only on
+     * the boot core, which finishes before the other cores are started. All
+     * other cores boot concurrently and only check that the fixed values are
+     * valid for them, and must not write to any shared state */
+    if (cpu == 0) {
+        vmcs_revision = vmx_basic_msr_get_vmcs_revision(vmx_basic);
         if (!init_vtx_fixed_values(vmx_basic_msr_get_true_msrs(vmx_basic))) {
             printf("vt-x: lack of required features\n");
             return false;
         }
+        init_vtx_msr_bitmaps();
+
+        /* The VMX_EPT_VPID_CAP MSR exists if VMX supports EPT or VPIDs. Whilst
+         * VPID support is optional, EPT support is not and is already checked for,
+         * so we know that this MSR is safe to read */
+        vpid_capability.words[0] = x86_rdmsr_low(IA32_VMX_EPT_VPID_CAP_MSR);
+        vpid_capability.words[1] = x86_rdmsr_high(IA32_VMX_EPT_VPID_CAP_MSR);
+
+        /* check for supported EPT features */
+        if (!vmx_ept_vpid_cap_msr_get_ept_wb(vpid_capability)) {
+            printf("vt-x: Expected wb attribute for EPT paging structure\n");
+            return false;
+        }
+        if (!vmx_ept_vpid_cap_msr_get_ept_2m(vpid_capability)) {
+            printf("vt-x: Expected supported for 2m pages\n");
+            return false;
+        }
     }
-    if (!check_vtx_fixed_values(vmx_basic_msr_get_true_msrs(vmx_basic))) {
+    if (vmx_basic_msr_get_vmcs_revision(vmx_basic) != vmcs_revision ||
+            !check_vtx_fixed_values(vmx_basic_msr_get_true_msrs(vmx_basic))) {
         printf("vt-x: cores have inconsistent features\n");
         return false;
     }
     write_cr4(read_cr4() | CR4_VMXE);
     /* we are required to set the VMCS region in the VMXON region */
-    vmxon_region.revision = vmcs_revision;
+    vmxon_region[cpu].revision = vmcs_revision;
     /* Before calling vmxon, we must check that CR0 and CR4 are not set to values
      * that are unsupported by vt-x */
     if (!vtx_check_fixed_values(read_cr0(), read_cr4())) {
         return false;
     }
-    if (vmxon(kpptr_to_paddr(&vmxon_region))) {
+    if (vmxon(kpptr_to_paddr(&vmxon_region[cpu]))) {
         printf("vt-x: vmxon failure\n");
         return false;
     }
-    memset(&msr_bitmap_region, ~0, sizeof(msr_bitmap_region));
-    /* Set sysenter MSRs to writeable and readable. These are all low msrs */
-    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_CS_MSR);
-    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_ESP_MSR);
-    clear_bit(msr_bitmap_region.low_msr_read.bitmap, IA32_SYSENTER_EIP_MSR);
-    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_CS_MSR);
-    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_ESP_MSR);
-    clear_bit(msr_bitmap_region.low_msr_write.bitmap, IA32_SYSENTER_EIP_MSR);
-
-    /* The VMX_EPT_VPID_CAP MSR exists if VMX supports EPT or VPIDs. Whilst
-     * VPID support is optional, EPT support is not and is already checked for,
-     * so we know that this MSR is safe to read */
-    vpid_capability.words[0] = x86_rdmsr_low(IA32_VMX_EPT_VPID_CAP_MSR);
-    vpid_capability.words[1] = x86_rdmsr_high(IA32_VMX_EPT_VPID_CAP_MSR);
-
-    /* check for supported EPT features */
-    if (!vmx_ept_vpid_cap_msr_get_ept_wb(vpid_capability)) {
-        printf("vt-x: Expected wb attribute for EPT paging structure\n");
-        return false;
-    }
-    if (!vmx_ept_vpid_cap_msr_get_ept_2m(vpid_capability)) {
-        printf("vt-x: Expected supported for 2m pages\n");
-        return false;
-    }
 
     return true;
 }
@@ -1116,6 +1732,7 @@ static void
 setMRs_vmexit(uint32_t reason, word_t qualification)
 {
     word_t *buffer;
+    vcpu_t *vcpu;
     int i;
 
     buffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
@@ -1135,6 +1752,14 @@ setMRs_vmexit(uint32_t reason, word_t qualification)
     for (i = 0; i < n_vcpu_gp_register; i++) {
         setMR(NODE_STATE(ksCurThread), buffer, SEL4_VMENTER_FAULT_EAX + i, NODE_STATE(ksCurThread)->tcbArch.tcbVCPU->gp_registers[i]);
     }
+
+    /* Append any additional fields the VCPU owner asked for, saving it
+     * from reading them with ReadVMCS after every exit */
+    vcpu = NODE_STATE(ksCurThread)->tcbArch.tcbVCPU;
+    for (i = 0; i < vcpu->exit_snapshot_count; i++) {
+        setMR(NODE_STATE(ksCurThread), buffer, SEL4_VMENTER_FAULT_SNAPSHOT_START + i,
+              readVMCSField(vcpu, vcpu->exit_snapshot[i]));
+    }
 }
 
 static void
@@ -1179,6 +1804,148 @@ finishVmexitSaving(void)
     }
 }
 
+static void
+skipGuestInstruction(void)
+{
+    word_t interruptibility;
+
+    vmwrite(VMX_GUEST_RIP, vmread(VMX_GUEST_RIP) + vmread(VMX_DATA_EXIT_INSTRUCTION_LENGTH));
+    /* Completing the instruction ends any blocking by STI or MOV SS, which are
+     * the bottom two bits of the interruptibility state */
+    interruptibility = vmread(VMX_GUEST_INTERRUPTABILITY);
+    if (interruptibility & MASK(2)) {
+        vmwrite(VMX_GUEST_INTERRUPTABILITY, interruptibility & ~MASK(2));
+    }
+}
+
+static bool_t
+handleCPUIDExit(vcpu_t *vcpu)
+{
+    uint32_t leaf = vcpu->gp_registers[VCPU_EAX];
+    uint32_t subleaf = vcpu->gp_registers[VCPU_ECX];
+    int i;
+
+    for (i = 0; i < SEL4_VMEXIT_POLICY_NUM_CPUID; i++) {
+        vcpu_cpuid_exit_t *entry = &vcpu->exit_policy.cpuid[i];
+        if ((entry->flags & SEL4_VMEXIT_POLICY_ENABLE) && entry->leaf == leaf &&
+                ((entry->flags & SEL4_VMEXIT_POLICY_ANY_SUBLEAF) || entry->subleaf == subleaf)) {
+            vcpu->gp_registers[VCPU_EAX] = entry->eax;
+            vcpu->gp_registers[VCPU_EBX] = entry->ebx;
+            vcpu->gp_registers[VCPU_ECX] = entry->ecx;
+            vcpu->gp_registers[VCPU_EDX] = entry->edx;
+            return true;
+        }
+    }
+    return false;
+}
+
+static vcpu_msr_exit_t *
+lookupMSRExit(vcpu_t *vcpu, uint32_t msr)
+{
+    int i;
+
+    for (i = 0; i < SEL4_VMEXIT_POLICY_NUM_MSR; i++) {
+        vcpu_msr_exit_t *entry = &vcpu->exit_policy.msr[i];
+        if ((entry->flags & SEL4_VMEXIT_POLICY_ENABLE) && entry->msr == msr) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static bool_t
+handleRDMSRExit(vcpu_t *vcpu)
+{
+    vcpu_msr_exit_t *entry = lookupMSRExit(vcpu, vcpu->gp_registers[VCPU_ECX]);
+
+    if (!entry) {
+        return false;
+    }
+    vcpu->gp_registers[VCPU_EAX] = (uint32_t)entry->value;
+    vcpu->gp_registers[VCPU_EDX] = (uint32_t)(entry->value >> 32);
+    return true;
+}
+
+static bool_t
+handleWRMSRExit(vcpu_t *vcpu)
+{
+    vcpu_msr_exit_t *entry = lookupMSRExit(vcpu, vcpu->gp_registers[VCPU_ECX]);
+
+    if (!entry || !(entry->flags & SEL4_VMEXIT_POLICY_WRITABLE)) {
+        return false;
+    }
+    entry->value = ((uint64_t)(uint32_t)vcpu->gp_registers[VCPU_EDX] << 32) |
+                   (uint32_t)vcpu->gp_registers[VCPU_EAX];
+    return true;
+}
+
+static bool_t
+handleIOExit(vcpu_t *vcpu, word_t qualification)
+{
+    vmx_data_exit_qualification_io_t qual;
+    word_t size;
+    word_t size_mask;
+    int i;
+
+    qual.words[0] = qualification;
+    /* Only single, non string, port reads are completed by the kernel. Anything
+     * else requires knowledge of the device and goes to the VCPU owner */
+    if (!vmx_data_exit_qualification_io_get_direction(qual) ||
+            vmx_data_exit_qualification_io_get_string(qual) ||
+            vmx_data_exit_qualification_io_get_rep(qual)) {
+        return false;
+    }
+    for (i = 0; i < SEL4_VMEXIT_POLICY_NUM_IOPORT; i++) {
+        vcpu_io_exit_t *entry = &vcpu->exit_policy.io[i];
+        if ((entry->flags & SEL4_VMEXIT_POLICY_ENABLE) &&
+                entry->port == vmx_data_exit_qualification_io_get_port(qual)) {
+            /* size is encoded as the number of bytes minus one. A 32-bit IN
+             * replaces the whole register, smaller ones only replace the low
+             * bytes of EAX */
+            size = vmx_data_exit_qualification_io_get_size(qual) + 1;
+            if (size == 4) {
+                vcpu->gp_registers[VCPU_EAX] = entry->value;
+            } else {
+                size_mask = MASK(size * 8);
+                vcpu->gp_registers[VCPU_EAX] = (vcpu->gp_registers[VCPU_EAX] & ~size_mask) |
+                                               (entry->value & size_mask);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Attempts to complete the exit using the exit policy table of the current VCPU.
+ * Returns true if the exit was completed and the guest can be resumed */
+static bool_t
+handleVmexitPolicy(uint32_t reason)
+{
+    vcpu_t *vcpu = NODE_STATE(ksCurThread)->tcbArch.tcbVCPU;
+    bool_t handled;
+
+    switch (reason) {
+    case CPUID:
+        handled = handleCPUIDExit(vcpu);
+        break;
+    case RDMSR:
+        handled = handleRDMSRExit(vcpu);
+        break;
+    case WRMSR:
+        handled = handleWRMSRExit(vcpu);
+        break;
+    case IO:
+        handled = handleIOExit(vcpu, vmread(VMX_DATA_EXIT_QUALIFICATION));
+        break;
+    default:
+        handled = false;
+    }
+    if (handled) {
+        skipGuestInstruction();
+    }
+    return handled;
+}
+
 exception_t
 handleVmexit(void)
 {
@@ -1189,6 +1956,10 @@ handleVmexit(void)
     finishVmexitSaving();
     /* the basic exit reason is the bottom 16 bits of the exit reason field */
     reason = vmread(VMX_DATA_EXIT_REASON) & MASK(16);
+#ifdef TRACK_KERNEL_ENTRIES
+    ksKernelEntry.vmexit_reason = reason;
+    ksKernelEntry.vmexit_in_kernel = 0;
+#endif
     if (reason == EXTERNAL_INTERRUPT) {
         if (vmx_feature_ack_on_exit) {
             interrupt = vmread(VMX_DATA_EXIT_INTERRUPT_INFO);
@@ -1288,6 +2059,14 @@ handleVmexit(void)
             }
         }
     }
+
+    if (handleVmexitPolicy(reason)) {
+#ifdef TRACK_KERNEL_ENTRIES
+        ksKernelEntry.vmexit_in_kernel = 1;
+#endif
+        return EXCEPTION_NONE;
+    }
+
     switch (reason) {
     case EXCEPTION_OR_NMI:
     case MOV_DR:
@@ -1375,6 +2154,7 @@ static void
 setEPTRoot(cap_t vmxSpace, vcpu_t* vcpu)
 {
     paddr_t ept_root;
+    bool_t ad_enabled = false;
     if (cap_get_capType(vmxSpace) != cap_ept_pml4_cap ||
             !cap_ept_pml4_cap_get_capPML4IsMapped(vmxSpace)) {
         ept_root = kpptr_to_paddr(null_ept_space);
@@ -1388,16 +2168,19 @@ setEPTRoot(cap_t vmxSpace, vcpu_t* vcpu)
             ept_root = kpptr_to_paddr(null_ept_space);
         } else {
             ept_root = pptr_to_paddr(pml4);
+            ad_enabled = find_ret.ad_enabled;
         }
     }
-    if (ept_root != vcpu->last_ept_root) {
-        vcpu->last_ept_root = ept_root;
-        vmx_eptp_t eptp = vmx_eptp_new(
-                              ept_root,       /* paddr of ept */
-                              0,              /* do not use accessed and dirty flags */
-                              3,              /* depth (4) minus 1 of desired table walking */
-                              6               /* write back memory type */
-                          );
+    vmx_eptp_t eptp = vmx_eptp_new(
+                          ept_root,       /* paddr of ept */
+                          ad_enabled,     /* use accessed and dirty flags if enabled for this ept */
+                          3,              /* depth (4) minus 1 of desired table walking */
+                          6               /* write back memory type */
+                      );
+    /* the accessed and dirty flags can be enabled for an ept that is already
+     * in use, so compare the whole eptp and not just the root */
+    if (eptp.words[0] != vcpu->last_eptp) {
+        vcpu->last_eptp = eptp.words[0];
         vmwrite(VMX_CONTROL_EPT_POINTER, eptp.words[0]);
         assert(vcpu->vpid != VPID_INVALID);
         if (vmx_feature_vpid) {
@@ -1553,9 +2336,24 @@ restoreVMCS(void)
         }
     }
     setEPTRoot(TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbArchEPTRoot)->cap, expected_vmcs);
+    if (expected_vmcs->virtual_apic_enabled) {
+        syncPostedInterrupts(expected_vmcs);
+    }
     handleLazyFpu();
 }
 
+bool_t
+vtx_ept_1g_supported(void)
+{
+    return vmx_ept_vpid_cap_msr_get_ept_1g(vpid_capability);
+}
+
+bool_t
+vtx_ept_ad_supported(void)
+{
+    return vmx_ept_vpid_cap_msr_get_ept_flags(vpid_capability);
+}
+
 void
 invept(ept_pml4e_t *ept_pml4)
 {
@@ -14,6 +14,7 @@
 #include <mode/smp/ipi.h>
 #include <smp/ipi.h>
 #include <smp/lock.h>
+#include <arch/kernel/idle.h>
 
 #ifdef ENABLE_SMP_SUPPORT
 
@@ -127,6 +128,10 @@ void ipi_send_mask(irq_t ipi, word_t mask, bool_t isBlocking)
 {
     interrupt_t interrupt_ipi = ipi + IRQ_INT_OFFSET;
 
+#if defined(CONFIG_X86_IDLE_MWAIT) && defined(CONFIG_BENCHMARK_TRACK_UTILISATION)
+    x86_idle_mark_wake_request(mask);
+#endif
+
 #ifdef CONFIG_USE_LOGICAL_IDS
     x86_ipi_send_mask(interrupt_ipi, mask, isBlocking);
 #else
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#include <config.h>
+#include <benchmark/benchmark_boot.h>
+#include <model/statedata.h>
+
+#ifdef CONFIG_BENCHMARK_BOOT_PROFILING
+
+/* Phases are recorded here as they complete, as the early ones complete before
+ * the bootinfo exists */
+timestamp_t ksBootPhaseEnd[CONFIG_MAX_NUM_NODES][seL4_NumBootPhases] BOOT_DATA;
+
+static seL4_BootInfo_Profile_t *boot_profile BOOT_DATA;
+
+BOOT_CODE void
+benchmark_boot_init_bi(seL4_BootInfo_Profile_t *profile)
+{
+    profile->header.id = SEL4_BOOTINFO_HEADER_BOOT_PROFILE;
+    profile->header.len = BENCHMARK_BOOT_PROFILE_SIZE;
+    boot_profile = profile;
+}
+
+/* Record the exit phase of the boot node and copy the phases of the nodes that
+ * booted into the bootinfo. This must be called once all other nodes have
+ * finished booting, so that ksNumCPUs is the number of nodes that did */
+BOOT_CODE void
+benchmark_boot_finalise(void)
+{
+    benchmark_boot_phase(0, seL4_BootPhase_Exit);
+    if (boot_profile) {
+        boot_profile->numNodes = ksNumCPUs;
+        for (word_t i = 0; i < ksNumCPUs; i++) {
+            for (word_t j = 0; j < seL4_NumBootPhases; j++) {
+                boot_profile->timestamps[i][j] = ksBootPhaseEnd[i][j];
+            }
+        }
+    }
+}
+
+#endif /* CONFIG_BENCHMARK_BOOT_PROFILING */
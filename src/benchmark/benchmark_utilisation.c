@@ -17,6 +17,10 @@ bool_t benchmark_log_utilisation_enabled;
 timestamp_t ksEnter;
 timestamp_t benchmark_start_time;
 timestamp_t benchmark_end_time;
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+uint64_t benchmark_vcpu_switches;
+uint64_t benchmark_vcpu_switch_time;
+#endif /* CONFIG_ARM_HYPERVISOR_SUPPORT */
 
 void benchmark_track_utilisation_dump(void)
 {
@@ -50,6 +54,25 @@ void benchmark_track_utilisation_dump(void)
     buffer[BENCHMARK_TOTAL_UTILISATION] = benchmark_end_time - benchmark_start_time; /* Overall time */
 #endif /* CONFIG_ARM_ENABLE_PMU_OVERFLOW_INTERRUPT */
 
+#ifdef CONFIG_HAVE_FPU
+    buffer[BENCHMARK_TCB_FPU_FAULTS] = tcb->benchmark.fpu_faults;
+    buffer[BENCHMARK_TCB_FPU_EAGER_RESTORES] = tcb->benchmark.fpu_eager_restores;
+#endif /* CONFIG_HAVE_FPU */
+
+#ifdef CONFIG_ARM_HYPERVISOR_SUPPORT
+    buffer[BENCHMARK_VCPU_SWITCHES] = benchmark_vcpu_switches;
+    buffer[BENCHMARK_VCPU_SWITCH_TIME] = benchmark_vcpu_switch_time;
+#endif /* CONFIG_ARM_HYPERVISOR_SUPPORT */
+
+#ifdef CONFIG_X86_IDLE_MWAIT
+    x86_idle_stats_t *idle_stats = &ARCH_NODE_STATE_ON_CORE(x86KSidleStats, SMP_TERNARY(tcb->tcbAffinity, 0));
+    buffer[BENCHMARK_IDLE_TCBCPU_ENTRIES] = idle_stats->entries;
+    buffer[BENCHMARK_IDLE_TCBCPU_RESIDENCY] = idle_stats->residency;
+    buffer[BENCHMARK_IDLE_TCBCPU_DEEP_ENTRIES] = idle_stats->deep_entries;
+    buffer[BENCHMARK_IDLE_TCBCPU_IPI_WAKEUPS] = idle_stats->ipi_wakeups;
+    buffer[BENCHMARK_IDLE_TCBCPU_WAKE_LATENCY] = idle_stats->wake_latency;
+#endif /* CONFIG_X86_IDLE_MWAIT */
+
 }
 
 void benchmark_track_reset_utilisation(void)
@@ -71,5 +94,9 @@ void benchmark_track_reset_utilisation(void)
 
     tcb->benchmark.utilisation = 0;
     tcb->benchmark.schedule_start_time = 0;
+#ifdef CONFIG_HAVE_FPU
+    tcb->benchmark.fpu_faults = 0;
+    tcb->benchmark.fpu_eager_restores = 0;
+#endif
 }
 #endif /* CONFIG_BENCHMARK_TRACK_UTILISATION */
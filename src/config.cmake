@@ -38,6 +38,7 @@ add_sources(CFILES
     src/machine/io.c
     src/machine/registerset.c
     src/machine/fpu.c
+    src/benchmark/benchmark_boot.c
     src/benchmark/benchmark_track.c
     src/benchmark/benchmark_utilisation.c
     src/smp/lock.c
@@ -16,6 +16,44 @@
 #endif
 #include <benchmark/benchmark_utilisation.h>
 
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+#define FASTPATH_SYSCALL_MESSAGE_MASK \
+    ((word_t)CONFIG_FASTPATH_SYSCALL_MESSAGE_MASK & MASK(n_syscallMessage))
+#define FASTPATH_EXCEPTION_MESSAGE_MASK \
+    ((word_t)CONFIG_FASTPATH_EXCEPTION_MESSAGE_MASK & MASK(n_exceptionMessage))
+
+/* Send the registers of the fault message selected by mask, each at its
+ * index in the message */
+static inline void FORCE_INLINE
+fastpath_copy_fault_mrs(tcb_t *sender, tcb_t *dest, word_t *buffer, MessageID_t id, word_t mask)
+{
+    while (mask) {
+        word_t i = ctzl(mask);
+        setMR(dest, buffer, i, getRegister(sender, fault_messages[id][i]));
+        mask &= mask - 1;
+    }
+}
+
+/* Restore the registers of the fault message selected by mask from a reply */
+static inline void FORCE_INLINE
+fastpath_copy_fault_reply_mrs(tcb_t *sender, tcb_t *dest, word_t *buffer, MessageID_t id, word_t mask)
+{
+    bool_t archInfo = Arch_getSanitiseRegisterInfo(dest);
+
+    while (mask) {
+        word_t i = ctzl(mask);
+        register_t r = fault_messages[id][i];
+        mask &= mask - 1;
+
+        if (i < n_msgRegisters) {
+            setRegister(dest, r, sanitiseRegister(r, getRegister(sender, msgRegisters[i]), archInfo));
+        } else if (buffer) {
+            setRegister(dest, r, sanitiseRegister(r, buffer[i + 1], archInfo));
+        }
+    }
+}
+#endif /* CONFIG_FASTPATH_EXCEPTION_IPC */
+
 void
 #ifdef ARCH_X86
 NORETURN
@@ -204,12 +242,22 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
     length = seL4_MessageInfo_get_length(info);
     fault_type = seL4_Fault_get_seL4_FaultType(NODE_STATE(ksCurThread)->tcbFault);
 
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    /* Check there's no extra caps and there's no saved fault. Replies to
+     * exception faults may be longer than the message registers, so the
+     * length is checked once the caller is known. */
+    if (unlikely(seL4_MessageInfo_get_extraCaps(info) != 0 ||
+                 fault_type != seL4_Fault_NullFault)) {
+        slowpath(SysReplyRecv);
+    }
+#else
     /* Check there's no extra caps, the length is ok and there's no
      * saved fault. */
     if (unlikely(fastpath_mi_check(msgInfo) ||
                  fault_type != seL4_Fault_NullFault)) {
         slowpath(SysReplyRecv);
     }
+#endif
 
     /* Lookup the cap */
     ep_cap = lookup_fp(TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCTable)->cap,
@@ -252,12 +300,28 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
     }
 #endif
 
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    /* Check that the caller has not faulted, in which case a fault reply is
+       generated instead. Exception faults that are resumed by the reply are
+       handled here, other faults and replies that stop the caller are not. */
+    fault_type = seL4_Fault_get_seL4_FaultType(caller->tcbFault);
+    if (likely(fault_type == seL4_Fault_NullFault)) {
+        if (unlikely(length > n_msgRegisters)) {
+            slowpath(SysReplyRecv);
+        }
+    } else if (unlikely((fault_type != seL4_Fault_UnknownSyscall &&
+                         fault_type != seL4_Fault_UserException) ||
+                        seL4_MessageInfo_get_label(info) != 0)) {
+        slowpath(SysReplyRecv);
+    }
+#else
     /* Check that the caller has not faulted, in which case a fault
        reply is generated instead. */
     fault_type = seL4_Fault_get_seL4_FaultType(caller->tcbFault);
     if (unlikely(fault_type != seL4_Fault_NullFault)) {
         slowpath(SysReplyRecv);
     }
+#endif
 
     /* Get destination thread.*/
     newVTable = TCB_PTR_CTE_PTR(caller, tcbVTable)->cap;
@@ -350,6 +414,34 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
     callerSlot->cap = cap_null_cap_new();
     callerSlot->cteMDBNode = nullMDBNode;
 
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    if (unlikely(fault_type != seL4_Fault_NullFault)) {
+        word_t *buffer = NULL;
+        word_t mask;
+
+        if (fault_type == seL4_Fault_UnknownSyscall) {
+            mask = FASTPATH_SYSCALL_MESSAGE_MASK & MASK(MIN(length, n_syscallMessage));
+        } else {
+            mask = FASTPATH_EXCEPTION_MESSAGE_MASK & MASK(MIN(length, n_exceptionMessage));
+        }
+        if (mask & ~MASK(n_msgRegisters)) {
+            buffer = lookupIPCBuffer(false, NODE_STATE(ksCurThread));
+        }
+        fastpath_copy_fault_reply_mrs(NODE_STATE(ksCurThread), caller, buffer,
+                                      fault_type == seL4_Fault_UnknownSyscall ?
+                                      MessageID_Syscall : MessageID_Exception, mask);
+        caller->tcbFault = seL4_Fault_NullFault_new();
+
+        /* The caller restarts at the faulting instruction, and as it did not
+         * enter the kernel through a syscall all of its registers are restored */
+        setNextPC(caller, getRestartPC(caller));
+        thread_state_ptr_set_tsType_np(&caller->tcbState,
+                                       ThreadState_Running);
+        switchToThread_fp(caller, cap_pd, stored_hw_asid);
+        restore_user_context();
+    }
+#endif /* CONFIG_FASTPATH_EXCEPTION_IPC */
+
     /* I know there's no fault, so straight to the transfer. */
 
     /* Replies don't have a badge. */
@@ -366,3 +458,189 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
 
     fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
 }
+
+#if defined(CONFIG_FASTPATH_VM_FAULT) || defined(CONFIG_FASTPATH_EXCEPTION_IPC)
+/* Deliver the fault in current_fault to the fault handler of the current
+ * thread when the handler is waiting and can be switched to directly. This
+ * returns, leaving current_fault untouched, when the slowpath must be used */
+void
+fastpath_fault(void)
+{
+    cap_t ep_cap;
+    endpoint_t *ep_ptr;
+    word_t length;
+    tcb_t *dest;
+    word_t badge;
+    word_t *buffer;
+    cte_t *replySlot, *callerSlot;
+    cap_t newVTable;
+    vspace_root_t *cap_pd;
+    pde_t stored_hw_asid;
+    dom_t dom;
+    word_t msgInfo;
+    word_t fault_type;
+
+    fault_type = seL4_Fault_get_seL4_FaultType(current_fault);
+
+    /* Lookup the fault handler cap */
+    ep_cap = lookup_fp(TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCTable)->cap,
+                       NODE_STATE(ksCurThread)->tcbFaultHandler);
+
+    /* Check it's an endpoint that faults can be sent on */
+    if (unlikely(!cap_capType_equals(ep_cap, cap_endpoint_cap) ||
+                 !cap_endpoint_cap_get_capCanSend(ep_cap) ||
+                 !cap_endpoint_cap_get_capCanGrant(ep_cap))) {
+        return;
+    }
+
+    /* Get the endpoint address */
+    ep_ptr = EP_PTR(cap_endpoint_cap_get_capEPPtr(ep_cap));
+
+    /* Get the destination thread, which is only going to be valid
+     * if the endpoint is valid. */
+    dest = TCB_PTR(endpoint_ptr_get_epQueue_head(ep_ptr));
+
+    /* Check that there's a thread waiting to receive */
+    if (unlikely(endpoint_ptr_get_state(ep_ptr) != EPState_Recv)) {
+        return;
+    }
+
+    /* ensure we are not single stepping the destination in ia32 */
+#if defined(CONFIG_HARDWARE_DEBUG_API) && defined(CONFIG_ARCH_IA32)
+    if (dest->tcbArch.tcbContext.breakpointState.single_step_enabled) {
+        return;
+    }
+#endif
+
+    /* Get destination thread.*/
+    newVTable = TCB_PTR_CTE_PTR(dest, tcbVTable)->cap;
+
+    /* Get vspace root. */
+    cap_pd = cap_vtable_cap_get_vspace_root_fp(newVTable);
+
+    /* Ensure that the destination has a valid VTable. */
+    if (unlikely(! isValidVTableRoot_fp(newVTable))) {
+        return;
+    }
+
+#ifdef CONFIG_ARCH_AARCH32
+    /* Get HW ASID */
+    stored_hw_asid = cap_pd[PD_ASID_SLOT];
+#endif
+
+#ifdef CONFIG_ARCH_X86_64
+    /* borrow the stored_hw_asid for PCID */
+    stored_hw_asid.words[0] = cap_pml4_cap_get_capPML4MappedASID_fp(newVTable);
+#endif
+
+#ifdef CONFIG_ARCH_AARCH64
+    stored_hw_asid.words[0] = cap_page_global_directory_cap_get_capPGDMappedASID(newVTable);
+#endif
+
+    /* let gcc optimise this out for 1 domain */
+    dom = maxDom ? ksCurDomain : 0;
+    /* ensure only the idle thread or lower prio threads are present in the scheduler */
+    if (likely(dest->tcbPriority < NODE_STATE(ksCurThread->tcbPriority)) &&
+            !isHighestPrio(dom, dest->tcbPriority)) {
+        return;
+    }
+
+#ifdef CONFIG_ARCH_AARCH32
+    if (unlikely(!pde_pde_invalid_get_stored_asid_valid(stored_hw_asid))) {
+        return;
+    }
+#endif
+
+    /* Ensure the fault handler is in the current domain and can be scheduled directly. */
+    if (unlikely(dest->tcbDomain != ksCurDomain && maxDom)) {
+        return;
+    }
+
+#ifdef ENABLE_SMP_SUPPORT
+    /* Ensure both threads have the same affinity */
+    if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != dest->tcbAffinity)) {
+        return;
+    }
+#endif /* ENABLE_SMP_SUPPORT */
+
+    /*
+     * --- POINT OF NO RETURN ---
+     *
+     * At this stage, we have committed to sending the fault.
+     */
+
+#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+    ksKernelEntry.is_fastpath = true;
+#endif
+
+    NODE_STATE(ksCurThread)->tcbFault = current_fault;
+
+    /* Dequeue the destination. */
+    endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(dest->tcbEPNext));
+    if (unlikely(dest->tcbEPNext)) {
+        dest->tcbEPNext->tcbEPPrev = NULL;
+    } else {
+        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, 0, EPState_Idle);
+    }
+
+    badge = cap_endpoint_cap_get_capEPBadge(ep_cap);
+
+    /* Block the faulting thread */
+    thread_state_ptr_set_tsType_np(&NODE_STATE(ksCurThread)->tcbState,
+                                   ThreadState_BlockedOnReply);
+
+    /* Get sender reply slot */
+    replySlot = TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbReply);
+
+    /* Get dest caller slot */
+    callerSlot = TCB_PTR_CTE_PTR(dest, tcbCaller);
+
+    /* Insert reply cap */
+    cap_reply_cap_ptr_new_np(&callerSlot->cap, 0, TCB_REF(NODE_STATE(ksCurThread)));
+    mdb_node_ptr_set_mdbPrev_np(&callerSlot->cteMDBNode, CTE_REF(replySlot));
+    mdb_node_ptr_mset_mdbNext_mdbRevocable_mdbFirstBadged(
+        &replySlot->cteMDBNode, CTE_REF(callerSlot), 1, 1);
+
+    switch (fault_type) {
+#ifdef CONFIG_FASTPATH_EXCEPTION_IPC
+    case seL4_Fault_UnknownSyscall:
+        buffer = lookupIPCBuffer(true, dest);
+        fastpath_copy_fault_mrs(NODE_STATE(ksCurThread), dest, buffer, MessageID_Syscall,
+                                FASTPATH_SYSCALL_MESSAGE_MASK);
+        length = setMR(dest, buffer, n_syscallMessage,
+                       seL4_Fault_UnknownSyscall_get_syscallNumber(current_fault));
+        break;
+
+    case seL4_Fault_UserException:
+        buffer = lookupIPCBuffer(true, dest);
+        fastpath_copy_fault_mrs(NODE_STATE(ksCurThread), dest, buffer, MessageID_Exception,
+                                FASTPATH_EXCEPTION_MESSAGE_MASK);
+        setMR(dest, buffer, n_exceptionMessage,
+              seL4_Fault_UserException_get_number(current_fault));
+        length = setMR(dest, buffer, n_exceptionMessage + 1u,
+                       seL4_Fault_UserException_get_code(current_fault));
+        break;
+#endif /* CONFIG_FASTPATH_EXCEPTION_IPC */
+
+    default:
+        /* The IPC buffer is only needed when the fault message does not fit
+         * in the message registers */
+        if ((word_t)seL4_VMFault_Length > n_msgRegisters) {
+            buffer = lookupIPCBuffer(true, dest);
+        } else {
+            buffer = NULL;
+        }
+        length = Arch_setMRs_fault(NODE_STATE(ksCurThread), dest, buffer, fault_type);
+        break;
+    }
+
+    /* Dest thread is set Running, but not queued. */
+    thread_state_ptr_set_tsType_np(&dest->tcbState,
+                                   ThreadState_Running);
+    switchToThread_fp(dest, cap_pd, stored_hw_asid);
+
+    msgInfo = wordFromMessageInfo(seL4_MessageInfo_new(fault_type, 0, 0, length));
+
+    fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
+}
+#endif /* CONFIG_FASTPATH_VM_FAULT || CONFIG_FASTPATH_EXCEPTION_IPC */
@@ -311,25 +311,60 @@ provide_cap(cap_t root_cnode_cap, cap_t cap)
     return true;
 }
 
+/* Returns the virtual range of a region that can be mapped with large frames,
+ * which is empty unless the region's virtual and physical addresses agree
+ * modulo the large page size */
+BOOT_CODE v_region_t
+large_frames_of_region(region_t reg, sword_t pv_offset)
+{
+    vptr_t v_start = pptr_to_paddr((void*)(reg.start - pv_offset));
+    vptr_t v_end = pptr_to_paddr((void*)(reg.end - pv_offset));
+
+    if (!IS_ALIGNED(v_start - pptr_to_paddr((void*)reg.start), seL4_LargePageBits)) {
+        return V_REG_EMPTY;
+    }
+    v_start = ROUND_UP(v_start, seL4_LargePageBits);
+    v_end = ROUND_DOWN(v_end, seL4_LargePageBits);
+    if (v_start >= v_end) {
+        return V_REG_EMPTY;
+    }
+    return (v_region_t) {
+        v_start, v_end
+    };
+}
+
 BOOT_CODE create_frames_of_region_ret_t
 create_frames_of_region(
     cap_t    root_cnode_cap,
     cap_t    pd_cap,
     region_t reg,
     bool_t   do_map,
-    sword_t  pv_offset
+    sword_t  pv_offset,
+    bool_t   use_large
 )
 {
     pptr_t     f;
+    vptr_t     v;
+    word_t     frame_bits;
+    v_region_t large_v_reg = V_REG_EMPTY;
     cap_t      frame_cap;
     seL4_SlotPos slot_pos_before;
     seL4_SlotPos slot_pos_after;
 
     slot_pos_before = ndks_boot.slot_pos_cur;
 
-    for (f = reg.start; f < reg.end; f += BIT(PAGE_BITS)) {
+    /* large frames are only created where the caller has left out the
+     * page tables, see large_frames_of_region */
+    if (do_map && use_large) {
+        large_v_reg = large_frames_of_region(reg, pv_offset);
+    }
+
+    for (f = reg.start; f < reg.end; f += BIT(frame_bits)) {
+        v = pptr_to_paddr((void*)(f - pv_offset));
+        use_large = v >= large_v_reg.start && v < large_v_reg.end;
+        frame_bits = use_large ? seL4_LargePageBits : PAGE_BITS;
         if (do_map) {
-            frame_cap = create_mapped_it_frame_cap(pd_cap, f, pptr_to_paddr((void*)(f - pv_offset)), IT_ASID, false, true);
+            frame_cap = create_mapped_it_frame_cap(pd_cap, f, v, IT_ASID, use_large, true);
         } else {
             frame_cap = create_unmapped_it_frame_cap(f, false);
         }
@@ -483,6 +518,9 @@ init_core_state(tcb_t *scheduler_action)
 #ifdef CONFIG_HAVE_FPU
     NODE_STATE(ksActiveFPUState) = NULL;
 #endif
+#ifdef CONFIG_FPU_EAGER
+    NODE_STATE(ksFPULastThread) = NULL;
+#endif
 #ifdef CONFIG_DEBUG_BUILD
     /* add initial threads to the debug queue */
     NODE_STATE(ksDebugTCBs) = NULL;
@@ -494,6 +532,9 @@ init_core_state(tcb_t *scheduler_action)
 #endif
     NODE_STATE(ksSchedulerAction) = scheduler_action;
     NODE_STATE(ksCurThread) = NODE_STATE(ksIdleThread);
+#ifdef CONFIG_THREAD_CPU_TIME
+    NODE_STATE(ksCurThreadStart) = getCPUTimestamp();
+#endif
 }
 
 BOOT_CODE static bool_t
@@ -15,8 +15,9 @@
 #include <kernel/cspace.h>
 #include <model/statedata.h>
 #include <arch/machine.h>
+#include <linker.h>
 
-lookupCap_ret_t
+HOT_CODE lookupCap_ret_t
 lookupCap(tcb_t *thread, cptr_t cPtr)
 {
     lookupSlot_raw_ret_t lu_ret;
@@ -34,7 +35,7 @@ lookupCap(tcb_t *thread, cptr_t cPtr)
     return ret;
 }
 
-lookupCapAndSlot_ret_t
+HOT_CODE lookupCapAndSlot_ret_t
 lookupCapAndSlot(tcb_t *thread, cptr_t cPtr)
 {
     lookupSlot_raw_ret_t lu_ret;
@@ -134,7 +135,7 @@ lookupPivotSlot(cap_t root, cptr_t capptr, word_t depth)
     return lookupSlotForCNodeOp(true, root, capptr, depth);
 }
 
-resolveAddressBits_ret_t
+HOT_CODE resolveAddressBits_ret_t
 resolveAddressBits(cap_t nodeCap, cptr_t capptr, word_t n_bits)
 {
     resolveAddressBits_ret_t ret;
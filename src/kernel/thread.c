@@ -50,7 +50,7 @@ configureIdleThread(tcb_t *tcb)
     setThreadState(tcb, ThreadState_IdleThreadState);
 }
 
-void
+HOT_CODE void
 activateThread(void)
 {
     switch (thread_state_get_tsType(NODE_STATE(ksCurThread)->tcbState)) {
@@ -98,7 +98,7 @@ restart(tcb_t *target)
     }
 }
 
-void
+HOT_CODE void
 doIPCTransfer(tcb_t *sender, endpoint_t *endpoint, word_t badge,
               bool_t grant, tcb_t *receiver)
 {
@@ -115,7 +115,7 @@ doIPCTransfer(tcb_t *sender, endpoint_t *endpoint, word_t badge,
     }
 }
 
-void
+HOT_CODE void
 doReplyTransfer(tcb_t *sender, tcb_t *receiver, cte_t *slot)
 {
     assert(thread_state_get_tsType(receiver->tcbState) ==
@@ -143,7 +143,7 @@ doReplyTransfer(tcb_t *sender, tcb_t *receiver, cte_t *slot)
     }
 }
 
-void
+HOT_CODE void
 doNormalTransfer(tcb_t *sender, word_t *sendBuffer, endpoint_t *endpoint,
                  word_t badge, bool_t canGrant, tcb_t *receiver,
                  word_t *receiveBuffer)
@@ -274,7 +274,7 @@ scheduleChooseNewThread(void)
     chooseThread();
 }
 
-void
+HOT_CODE void
 schedule(void)
 {
     if (NODE_STATE(ksSchedulerAction) != SchedulerAction_ResumeCurrentThread) {
@@ -323,7 +323,7 @@ schedule(void)
 #endif /* ENABLE_SMP_SUPPORT */
 }
 
-void
+HOT_CODE void
 chooseThread(void)
 {
     word_t prio;
@@ -347,11 +347,14 @@ chooseThread(void)
     }
 }
 
-void
+HOT_CODE void
 switchToThread(tcb_t *thread)
 {
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     benchmark_utilisation_switch(NODE_STATE(ksCurThread), thread);
+#endif
+#ifdef CONFIG_THREAD_CPU_TIME
+    chargeCurThreadCPUTime();
 #endif
     Arch_switchToThread(thread);
     tcbSchedDequeue(thread);
@@ -363,6 +366,9 @@ switchToIdleThread(void)
 {
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
     benchmark_utilisation_switch(NODE_STATE(ksCurThread), NODE_STATE(ksIdleThread));
+#endif
+#ifdef CONFIG_THREAD_CPU_TIME
+    chargeCurThreadCPUTime();
 #endif
     Arch_switchToIdleThread();
     NODE_STATE(ksCurThread) = NODE_STATE(ksIdleThread);
@@ -402,7 +408,7 @@ setPriority(tcb_t *tptr, prio_t prio)
  * entry. Do not queue it yet, since a queue+unqueue operation is wasteful
  * if it will be picked. Instead, it waits in the 'ksSchedulerAction' site
  * on which the scheduler will take action. */
-void
+HOT_CODE void
 possibleSwitchTo(tcb_t* target)
 {
     if (ksCurDomain != target->tcbDomain
@@ -417,14 +423,14 @@ possibleSwitchTo(tcb_t* target)
     }
 }
 
-void
+HOT_CODE void
 setThreadState(tcb_t *tptr, _thread_state_t ts)
 {
     thread_state_ptr_set_tsType(&tptr->tcbState, ts);
     scheduleTCB(tptr);
 }
 
-void
+HOT_CODE void
 scheduleTCB(tcb_t *tptr)
 {
     if (tptr == NODE_STATE(ksCurThread) &&
@@ -456,7 +462,7 @@ timerTick(void)
     }
 }
 
-void
+HOT_CODE void
 rescheduleRequired(void)
 {
     if (NODE_STATE(ksSchedulerAction) != SchedulerAction_ResumeCurrentThread
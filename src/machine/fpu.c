@@ -45,6 +45,18 @@ void switchFpuOwner(user_fpu_state_t *new_owner, word_t cpu)
     }
 }
 
+#ifdef CONFIG_FPU_EAGER
+/* Switch the FPU to a thread that has been using it on every switch, instead
+ * of waiting for it to take an FPU fault. */
+void eagerFPURestore(tcb_t *thread)
+{
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    thread->benchmark.fpu_eager_restores++;
+#endif
+    switchLocalFpuOwner(&thread->tcbArch.tcbContext.fpuState);
+}
+#endif /* CONFIG_FPU_EAGER */
+
 /* Handle a FPU fault.
  *
  * This CPU exception is thrown when userspace attempts to use the FPU while
@@ -58,6 +70,13 @@ handleFPUFault(void)
      * we presumably are happy to assume will not be running seL4. */
     assert(!nativeThreadUsingFPU(NODE_STATE(ksCurThread)));
 
+#ifdef CONFIG_FPU_EAGER
+    fpuUsageFault(NODE_STATE(ksCurThread));
+#endif
+#ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
+    NODE_STATE(ksCurThread)->benchmark.fpu_faults++;
+#endif
+
     /* Otherwise, lazily switch over the FPU. */
     switchLocalFpuOwner(&NODE_STATE(ksCurThread)->tcbArch.tcbContext.fpuState);
 
@@ -15,6 +15,28 @@
 
 #include <stdarg.h>
 
+#ifdef ENABLE_SMP_SUPPORT
+#include <arch/machine.h>
+
+/* Serialises the output of cores that print without holding the kernel lock,
+ * such as secondary cores booting concurrently */
+static bool_t console_lock;
+
+static inline void
+console_lock_acquire(void)
+{
+    while (__atomic_test_and_set(&console_lock, __ATOMIC_ACQUIRE)) {
+        arch_pause();
+    }
+}
+
+static inline void
+console_lock_release(void)
+{
+    __atomic_clear(&console_lock, __ATOMIC_RELEASE);
+}
+#endif /* ENABLE_SMP_SUPPORT */
+
 void
 putchar(char c)
 {
@@ -298,10 +320,16 @@ vprintf(const char *format, va_list ap)
 
 word_t puts(const char *s)
 {
+#ifdef ENABLE_SMP_SUPPORT
+    console_lock_acquire();
+#endif
     for (; *s; s++) {
         kernel_putchar(*s);
     }
     kernel_putchar('\n');
+#ifdef ENABLE_SMP_SUPPORT
+    console_lock_release();
+#endif
     return 0;
 }
 
@@ -311,9 +339,15 @@ kprintf(const char *format, ...)
     va_list args;
     word_t i;
 
+#ifdef ENABLE_SMP_SUPPORT
+    console_lock_acquire();
+#endif
     va_start(args, format);
     i = vprintf(format, args);
     va_end(args);
+#ifdef ENABLE_SMP_SUPPORT
+    console_lock_release();
+#endif
     return i;
 }
 
@@ -29,9 +29,15 @@ UP_STATE_DEFINE(tcb_queue_t, ksReadyQueues[NUM_READY_QUEUES]);
 UP_STATE_DEFINE(word_t, ksReadyQueuesL1Bitmap[CONFIG_NUM_DOMAINS]);
 UP_STATE_DEFINE(word_t, ksReadyQueuesL2Bitmap[CONFIG_NUM_DOMAINS][L2_BITMAP_SIZE]);
 compile_assert(ksReadyQueuesL1BitmapBigEnough, (L2_BITMAP_SIZE - 1) <= wordBits)
+#ifdef CONFIG_KERNEL_INFO_PAGE
+UP_STATE_DEFINE(word_t, ksReadyThreads);
+#endif
 
 /* Current thread TCB pointer */
 UP_STATE_DEFINE(tcb_t *, ksCurThread);
+#ifdef CONFIG_THREAD_CPU_TIME
+UP_STATE_DEFINE(uint64_t, ksCurThreadStart);
+#endif
 
 /* Idle thread TCB pointer */
 UP_STATE_DEFINE(tcb_t *, ksIdleThread);
@@ -46,6 +52,9 @@ UP_STATE_DEFINE(tcb_t *, ksSchedulerAction);
 UP_STATE_DEFINE(user_fpu_state_t *, ksActiveFPUState);
 
 UP_STATE_DEFINE(word_t, ksFPURestoresSinceSwitch);
+#ifdef CONFIG_FPU_EAGER
+UP_STATE_DEFINE(tcb_t *, ksFPULastThread);
+#endif
 #endif /* CONFIG_HAVE_FPU */
 
 #ifdef CONFIG_DEBUG_BUILD
@@ -36,6 +36,9 @@ typedef struct finaliseSlot_ret finaliseSlot_ret_t;
 static finaliseSlot_ret_t finaliseSlot(cte_t *slot, bool_t exposed);
 static void emptySlot(cte_t *slot, cap_t cleanupInfo);
 static exception_t reduceZombie(cte_t* slot, bool_t exposed);
+#ifdef CONFIG_REVOKE_BATCH
+static bool_t capTriviallyDeletable(cte_t *slot);
+#endif
 
 exception_t
 decodeCNodeInvocation(word_t invLabel, word_t length, cap_t cap,
@@ -561,12 +564,34 @@ cteRevoke(cte_t *slot)
 {
     cte_t *nextPtr;
     exception_t status;
+#ifdef CONFIG_REVOKE_BATCH
+    word_t batched = 0;
+#endif
 
     /* there is no need to check for a NullCap as NullCaps are
        always accompanied by null mdb pointers */
     for (nextPtr = CTE_PTR(mdb_node_get_mdbNext(slot->cteMDBNode));
             nextPtr && isMDBParentOf(slot, nextPtr);
             nextPtr = CTE_PTR(mdb_node_get_mdbNext(slot->cteMDBNode))) {
+#ifdef CONFIG_REVOKE_BATCH
+        if (capTriviallyDeletable(nextPtr)) {
+            /* Children that need no finalisation are emptied directly, and
+             * a batch of them counts as a single work unit */
+            emptySlot(nextPtr, cap_null_cap_new());
+            batched++;
+            if (batched < CONFIG_REVOKE_BATCH_SIZE) {
+                continue;
+            }
+            batched = 0;
+
+            status = preemptionPoint();
+            if (status != EXCEPTION_NONE) {
+                return status;
+            }
+            continue;
+        }
+        batched = 0;
+#endif
         status = cteDelete(nextPtr, true);
         if (status != EXCEPTION_NONE) {
             return status;
@@ -604,6 +629,10 @@ emptySlot(cte_t *slot, cap_t cleanupInfo)
         mdb_node_t mdbNode;
         cte_t *prev, *next;
 
+#ifdef CONFIG_UNTYPED_RECLAIM_LAST
+        reclaimUntypedObject(slot);
+#endif
+
         mdbNode = slot->cteMDBNode;
         prev = CTE_PTR(mdb_node_get_mdbPrev(mdbNode));
         next = CTE_PTR(mdb_node_get_mdbNext(mdbNode));
@@ -625,6 +654,33 @@ emptySlot(cte_t *slot, cap_t cleanupInfo)
     }
 }
 
+#ifdef CONFIG_REVOKE_BATCH
+/* Whether finalising the cap in the given slot does nothing, such that
+ * deleting it only has to empty the slot. This mirrors finaliseCap. */
+static bool_t
+capTriviallyDeletable(cte_t *slot)
+{
+    switch (cap_get_capType(slot->cap)) {
+    case cap_null_cap:
+    case cap_reply_cap:
+    case cap_domain_cap:
+    case cap_untyped_cap:
+    case cap_irq_control_cap:
+        return true;
+
+    case cap_endpoint_cap:
+    case cap_notification_cap:
+    case cap_cnode_cap:
+    case cap_thread_cap:
+    case cap_irq_handler_cap:
+        return !isFinalCapability(slot);
+
+    default:
+        return false;
+    }
+}
+#endif /* CONFIG_REVOKE_BATCH */
+
 static inline bool_t CONST
 capRemovable(cap_t cap, cte_t* slot)
 {
@@ -17,6 +17,7 @@
 #include <object/cnode.h>
 #include <object/endpoint.h>
 #include <object/tcb.h>
+#include <linker.h>
 
 static inline tcb_queue_t PURE
 ep_ptr_get_queue(endpoint_t *epptr)
@@ -36,7 +37,7 @@ ep_ptr_set_queue(endpoint_t *epptr, tcb_queue_t queue)
     endpoint_ptr_set_epQueue_tail(epptr, (word_t)queue.end);
 }
 
-void
+HOT_CODE void
 sendIPC(bool_t blocking, bool_t do_call, word_t badge,
         bool_t canGrant, tcb_t *thread, endpoint_t *epptr)
 {
@@ -107,7 +108,7 @@ sendIPC(bool_t blocking, bool_t do_call, word_t badge,
     }
 }
 
-void
+HOT_CODE void
 receiveIPC(tcb_t *thread, cap_t cap, bool_t isBlocking)
 {
     endpoint_t *epptr;
@@ -24,6 +24,7 @@
 #include <machine/timer.h>
 #include <plat/machine/timer.h>
 #include <smp/ipi.h>
+#include <linker.h>
 
 exception_t
 decodeIRQControlInvocation(word_t invLabel, word_t length,
@@ -184,7 +185,7 @@ deletedIRQHandler(irq_t irq)
     setIRQState(IRQInactive, irq);
 }
 
-void
+HOT_CODE void
 handleInterrupt(irq_t irq)
 {
     if (unlikely(irq > maxIRQ)) {
@@ -62,17 +62,23 @@ sendSignal(notification_t *ntfnPtr, word_t badge)
                 possibleSwitchTo(tcb);
 #ifdef CONFIG_VTX
             } else if (thread_state_ptr_get_tsType(&tcb->tcbState) == ThreadState_RunningVM) {
+                /* Badge bits that the VCPU has mapped to guest vectors are posted
+                 * straight to the guest, which then keeps running */
+                word_t remaining = vcpu_post_notification(tcb, badge);
+                if (remaining != 0 || badge == 0) {
+                    badge = remaining;
 #ifdef ENABLE_SMP_SUPPORT
-                if (tcb->tcbAffinity != getCurrentCPUIndex()) {
-                    ntfn_set_active(ntfnPtr, badge);
-                    doRemoteVMCheckBoundNotification(tcb->tcbAffinity, tcb);
-                } else
+                    if (tcb->tcbAffinity != getCurrentCPUIndex()) {
+                        ntfn_set_active(ntfnPtr, badge);
+                        doRemoteVMCheckBoundNotification(tcb->tcbAffinity, tcb);
+                    } else
 #endif /* ENABLE_SMP_SUPPORT */
-                {
-                    setThreadState(tcb, ThreadState_Running);
-                    setRegister(tcb, badgeRegister, badge);
-                    Arch_leaveVMAsyncTransfer(tcb);
-                    possibleSwitchTo(tcb);
+                    {
+                        setThreadState(tcb, ThreadState_Running);
+                        setRegister(tcb, badgeRegister, badge);
+                        Arch_leaveVMAsyncTransfer(tcb);
+                        possibleSwitchTo(tcb);
+                    }
                 }
 #endif /* CONFIG_VTX */
             } else {
@@ -28,6 +28,7 @@
 #include <kernel/vspace.h>
 #include <machine.h>
 #include <util.h>
+#include <linker.h>
 #include <string.h>
 
 word_t getObjectSize(word_t t, word_t userObjSize)
@@ -514,7 +515,7 @@ createNewObjects(object_t t, cte_t *parent, slot_range_t slots,
     }
 }
 
-exception_t
+HOT_CODE exception_t
 decodeInvocation(word_t invLabel, word_t length,
                  cptr_t capIndex, cte_t *slot, cap_t cap,
                  extra_caps_t excaps, bool_t block, bool_t call,
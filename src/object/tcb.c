@@ -24,6 +24,7 @@
 #include <kernel/vspace.h>
 #include <model/statedata.h>
 #include <util.h>
+#include <linker.h>
 #include <string.h>
 #include <stdint.h>
 #include <arch/smp/ipi_inline.h>
@@ -83,7 +84,7 @@ removeFromBitmap(word_t cpu, word_t dom, word_t prio)
 }
 
 /* Add TCB to the head of a scheduler queue */
-void
+HOT_CODE void
 tcbSchedEnqueue(tcb_t *tcb)
 {
     if (!thread_state_get_tcbQueued(tcb->tcbState)) {
@@ -110,6 +111,9 @@ tcbSchedEnqueue(tcb_t *tcb)
         NODE_STATE_ON_CORE(ksReadyQueues[idx], tcb->tcbAffinity) = queue;
 
         thread_state_ptr_set_tcbQueued(&tcb->tcbState, true);
+#ifdef CONFIG_KERNEL_INFO_PAGE
+        NODE_STATE_ON_CORE(ksReadyThreads, tcb->tcbAffinity)++;
+#endif
     }
 }
 
@@ -141,11 +145,14 @@ tcbSchedAppend(tcb_t *tcb)
         NODE_STATE_ON_CORE(ksReadyQueues[idx], tcb->tcbAffinity) = queue;
 
         thread_state_ptr_set_tcbQueued(&tcb->tcbState, true);
+#ifdef CONFIG_KERNEL_INFO_PAGE
+        NODE_STATE_ON_CORE(ksReadyThreads, tcb->tcbAffinity)++;
+#endif
     }
 }
 
 /* Remove TCB from a scheduler queue */
-void
+HOT_CODE void
 tcbSchedDequeue(tcb_t *tcb)
 {
     if (thread_state_get_tcbQueued(tcb->tcbState)) {
@@ -177,6 +184,9 @@ tcbSchedDequeue(tcb_t *tcb)
         NODE_STATE_ON_CORE(ksReadyQueues[idx], tcb->tcbAffinity) = queue;
 
         thread_state_ptr_set_tcbQueued(&tcb->tcbState, false);
+#ifdef CONFIG_KERNEL_INFO_PAGE
+        NODE_STATE_ON_CORE(ksReadyThreads, tcb->tcbAffinity)--;
+#endif
     }
 }
 
@@ -295,7 +305,7 @@ deleteCallerCap(tcb_t *receiver)
 
 extra_caps_t current_extra_caps;
 
-exception_t
+HOT_CODE exception_t
 lookupExtraCaps(tcb_t* thread, word_t *bufferPtr, seL4_MessageInfo_t info)
 {
     lookupSlot_raw_ret_t lu_ret;
@@ -328,7 +338,7 @@ lookupExtraCaps(tcb_t* thread, word_t *bufferPtr, seL4_MessageInfo_t info)
 }
 
 /* Copy IPC MRs from one thread to another */
-word_t
+HOT_CODE word_t
 copyMRs(tcb_t *sender, word_t *sendBuf, tcb_t *receiver,
         word_t *recvBuf, word_t n)
 {
@@ -660,6 +670,44 @@ decodeUnsetBreakpoint(cap_t cap, word_t *buffer)
 }
 #endif /* CONFIG_HARDWARE_DEBUG_API */
 
+#ifdef CONFIG_THREAD_CPU_TIME
+static exception_t
+invokeGetCPUTime(word_t *buffer, tcb_t *tcb, bool_t call)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    uint64_t time;
+    word_t i;
+
+    if (call) {
+        /* Include the current time slice of a running thread */
+        if (NODE_STATE_ON_CORE(ksCurThread, tcb->tcbAffinity) == tcb) {
+            time = tcb->tcbCPUTime + getCPUTimestamp() -
+                   NODE_STATE_ON_CORE(ksCurThreadStart, tcb->tcbAffinity);
+        } else {
+            time = tcb->tcbCPUTime;
+        }
+
+        setRegister(thread, badgeRegister, 0);
+        i = setMR(thread, buffer, 0, (word_t)time);
+#if CONFIG_WORD_SIZE == 32
+        i = setMR(thread, buffer, i, (word_t)(time >> 32));
+#endif
+        setRegister(thread, msgInfoRegister,
+                    wordFromMessageInfo(seL4_MessageInfo_new(0, 0, 0, i)));
+    }
+    setThreadState(thread, ThreadState_Running);
+
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeGetCPUTime(cap_t cap, word_t *buffer, bool_t call)
+{
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return invokeGetCPUTime(buffer, TCB_PTR(cap_thread_cap_get_capTCBPtr(cap)), call);
+}
+#endif /* CONFIG_THREAD_CPU_TIME */
+
 /* The following functions sit in the syscall error monad, but include the
  * exception cases for the preemptible bottom end, as they call the invoke
  * functions directly.  This is a significant deviation from the Haskell
@@ -743,6 +791,11 @@ decodeTCBInvocation(word_t invLabel, word_t length, cap_t cap,
         return decodeUnsetBreakpoint(cap, buffer);
 #endif
 
+#ifdef CONFIG_THREAD_CPU_TIME
+    case TCBGetCPUTime:
+        return decodeGetCPUTime(cap, buffer, call);
+#endif
+
     default:
         /* Haskell: "throw IllegalOperation" */
         userError("TCB: Illegal operation.");
@@ -304,3 +304,65 @@ invokeUntyped_Retype(cte_t *srcSlot,
 
     return EXCEPTION_NONE;
 }
+
+#ifdef CONFIG_UNTYPED_RECLAIM_LAST
+static inline bool_t CONST
+capReclaimable(cap_t cap)
+{
+    switch (cap_get_capType(cap)) {
+    case cap_endpoint_cap:
+    case cap_notification_cap:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/* Called as the cap in slot is deleted. If it is the last cap to an object
+ * that was the most recent allocation from its untyped, return the object's
+ * memory to the untyped by moving the untyped's free index back to the start
+ * of the object.
+ *
+ * Retype inserts each new cap directly after the untyped's cap, so the object
+ * ending at the free index is always the untyped's neighbour in the MDB, and
+ * memory is reused in last-in first-out order without any extra metadata.
+ * Objects deleted in any other order leave holes that are not tracked.
+ * Memory above the free index must be zero, so the object is cleared first;
+ * only small objects are reclaimed to bound the time this takes */
+void
+reclaimUntypedObject(cte_t *slot)
+{
+    cte_t *parentSlot;
+    cap_t untypedCap;
+    void *regionBase, *objectBase;
+    word_t objectSize, freeRef;
+
+    if (!capReclaimable(slot->cap)) {
+        return;
+    }
+
+    parentSlot = CTE_PTR(mdb_node_get_mdbPrev(slot->cteMDBNode));
+    if (parentSlot == NULL || cap_get_capType(parentSlot->cap) != cap_untyped_cap ||
+            !isFinalCapability(slot)) {
+        return;
+    }
+
+    untypedCap = parentSlot->cap;
+    regionBase = WORD_PTR(cap_untyped_cap_get_capPtr(untypedCap));
+    freeRef = GET_FREE_REF(regionBase, cap_untyped_cap_get_capFreeIndex(untypedCap));
+    objectBase = cap_get_capPtr(slot->cap);
+    objectSize = cap_get_capSizeBits(slot->cap);
+
+    if ((word_t)objectBase < (word_t)regionBase ||
+            (word_t)objectBase + BIT(objectSize) != freeRef) {
+        return;
+    }
+
+    if (!cap_untyped_cap_get_capIsDevice(untypedCap)) {
+        clearMemory(objectBase, objectSize);
+    }
+    parentSlot->cap = cap_untyped_cap_set_capFreeIndex(untypedCap,
+                                                       GET_FREE_INDEX(regionBase, objectBase));
+}
+#endif /* CONFIG_UNTYPED_RECLAIM_LAST */
@@ -26,6 +26,23 @@ config_string(KernelMaxRMRREntries MAX_RMRR_ENTRIES
     UNQUOTE
 )
 
+config_option(KernelNUMA NUMA
+    "Discover the NUMA topology from the ACPI SRAT and SLIT. Physical memory is split on \
+    NUMA node boundaries so that no untyped spans more than one node, and the node of each \
+    untyped, the node of each CPU and the distances between nodes are provided to the \
+    initial thread in an extra bootinfo header."
+    DEFAULT OFF
+    DEPENDS "KernelPlatPC99; NOT KernelVerificationBuild"
+)
+
+config_string(KernelMaxNumNUMANodes MAX_NUM_NUMA_NODES
+    "Maximum number of NUMA nodes the kernel records. Processors and memory in other \
+    nodes are not tagged with a node."
+    DEFAULT 8
+    DEPENDS "KernelNUMA" UNDEF_DISABLED
+    UNQUOTE
+)
+
 add_sources(
     DEP "KernelPlatPC99"
     PREFIX src/plat/pc99/machine
@@ -156,11 +156,84 @@ typedef struct acpi_madt_iso {
 unverified_compile_assert(acpi_madt_iso_packed,
                           OFFSETOF(acpi_madt_iso_t, flags) == sizeof(acpi_madt_header_t) + 6)
 
+#ifdef CONFIG_NUMA
+/* System Resource Affinity Table */
+typedef struct acpi_srat {
+    acpi_header_t header;
+    uint32_t      reserved1;
+    uint32_t      reserved2[2];
+} PACKED acpi_srat_t;
+compile_assert(acpi_srat_packed,
+               sizeof(acpi_srat_t) == sizeof(acpi_header_t) + 12)
+
+typedef struct acpi_srat_header {
+    uint8_t type;
+    uint8_t length;
+} PACKED acpi_srat_header_t;
+compile_assert(acpi_srat_header_packed, sizeof(acpi_srat_header_t) == 2)
+
+enum acpi_table_srat_struct_type {
+    SRAT_APIC      = 0,
+    SRAT_MEMORY    = 1,
+    SRAT_x2APIC    = 2
+};
+
+#define SRAT_FLAG_ENABLED BIT(0)
+
+typedef struct acpi_srat_apic {
+    acpi_srat_header_t header;
+    uint8_t            domain_low;
+    uint8_t            apic_id;
+    uint32_t           flags;
+    uint8_t            sapic_eid;
+    uint8_t            domain_high[3];
+    uint32_t           clock_domain;
+} PACKED acpi_srat_apic_t;
+compile_assert(acpi_srat_apic_packed,
+               sizeof(acpi_srat_apic_t) == sizeof(acpi_srat_header_t) + 14)
+
+typedef struct acpi_srat_memory {
+    acpi_srat_header_t header;
+    uint32_t           domain;
+    uint16_t           reserved1;
+    uint32_t           base[2];
+    uint32_t           length[2];
+    uint32_t           reserved2;
+    uint32_t           flags;
+    uint32_t           reserved3[2];
+} PACKED acpi_srat_memory_t;
+compile_assert(acpi_srat_memory_packed,
+               sizeof(acpi_srat_memory_t) == sizeof(acpi_srat_header_t) + 38)
+
+typedef struct acpi_srat_x2apic {
+    acpi_srat_header_t header;
+    uint16_t           reserved1;
+    uint32_t           domain;
+    uint32_t           x2apic_id;
+    uint32_t           flags;
+    uint32_t           clock_domain;
+    uint32_t           reserved2;
+} PACKED acpi_srat_x2apic_t;
+compile_assert(acpi_srat_x2apic_packed,
+               sizeof(acpi_srat_x2apic_t) == sizeof(acpi_srat_header_t) + 22)
+
+/* System Locality Information Table */
+typedef struct acpi_slit {
+    acpi_header_t header;
+    uint32_t      num_localities[2];
+    uint8_t       entry[];
+} PACKED acpi_slit_t;
+#endif /* CONFIG_NUMA */
+
 /* workaround because string literals are not supported by C parser */
 const char acpi_str_rsd[]  = {'R', 'S', 'D', ' ', 'P', 'T', 'R', ' ', 0};
 const char acpi_str_fadt[] = {'F', 'A', 'C', 'P', 0};
 const char acpi_str_apic[] = {'A', 'P', 'I', 'C', 0};
 const char acpi_str_dmar[] = {'D', 'M', 'A', 'R', 0};
+#ifdef CONFIG_NUMA
+const char acpi_str_srat[] = {'S', 'R', 'A', 'T', 0};
+const char acpi_str_slit[] = {'S', 'L', 'I', 'T', 0};
+#endif
 
 BOOT_CODE static uint8_t
 acpi_calc_checksum(char* start, uint32_t length)
@@ -554,3 +627,176 @@ acpi_dmar_scan(
     rmrr_list->num = rmrr_count;
     printf("ACPI: %d IOMMUs detected\n", *num_drhu);
 }
+
+#ifdef CONFIG_NUMA
+BOOT_CODE static void
+acpi_srat_set_cpu_node(
+    cpu_id_t*         cpu_list,
+    uint32_t          num_cpu,
+    acpi_numa_info_t* numa_info,
+    cpu_id_t          cpu_id,
+    uint32_t          domain
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_cpu; i++) {
+        if (cpu_list[i] == cpu_id) {
+            numa_info->cpu_node[i] = domain;
+        }
+    }
+}
+
+BOOT_CODE static void
+acpi_srat_parse(
+    acpi_srat_t*      acpi_srat_mapped,
+    cpu_id_t*         cpu_list,
+    uint32_t          num_cpu,
+    acpi_numa_info_t* numa_info
+)
+{
+    acpi_srat_header_t* acpi_srat_header;
+    uint32_t domain;
+
+    acpi_srat_header = (acpi_srat_header_t*)(acpi_srat_mapped + 1);
+
+    while ((char*)acpi_srat_header < (char*)acpi_srat_mapped + acpi_srat_mapped->header.length) {
+        switch (acpi_srat_header->type) {
+        case SRAT_APIC: {
+            acpi_srat_apic_t *apic = (acpi_srat_apic_t*)acpi_srat_header;
+            domain = apic->domain_low | (apic->domain_high[0] << 8) |
+                     (apic->domain_high[1] << 16) | (apic->domain_high[2] << 24);
+            if (!(apic->flags & SRAT_FLAG_ENABLED)) {
+                break;
+            }
+            if (domain >= CONFIG_MAX_NUM_NUMA_NODES) {
+                printf("ACPI: Ignoring SRAT_APIC apic_id=0x%x in domain %d, only support %d\n",
+                       apic->apic_id, domain, CONFIG_MAX_NUM_NUMA_NODES);
+                break;
+            }
+            printf("ACPI: SRAT_APIC apic_id=0x%x domain=%d\n", apic->apic_id, domain);
+            acpi_srat_set_cpu_node(cpu_list, num_cpu, numa_info, apic->apic_id, domain);
+            numa_info->num_nodes = MAX(numa_info->num_nodes, domain + 1);
+            break;
+        }
+        case SRAT_x2APIC: {
+            acpi_srat_x2apic_t *x2apic = (acpi_srat_x2apic_t*)acpi_srat_header;
+            domain = x2apic->domain;
+            if (!(x2apic->flags & SRAT_FLAG_ENABLED)) {
+                break;
+            }
+            if (domain >= CONFIG_MAX_NUM_NUMA_NODES) {
+                printf("ACPI: Ignoring SRAT_x2APIC apic_id=0x%x in domain %d, only support %d\n",
+                       x2apic->x2apic_id, domain, CONFIG_MAX_NUM_NUMA_NODES);
+                break;
+            }
+            printf("ACPI: SRAT_x2APIC apic_id=0x%x domain=%d\n", x2apic->x2apic_id, domain);
+            acpi_srat_set_cpu_node(cpu_list, num_cpu, numa_info, x2apic->x2apic_id, domain);
+            numa_info->num_nodes = MAX(numa_info->num_nodes, domain + 1);
+            break;
+        }
+        case SRAT_MEMORY: {
+            acpi_srat_memory_t *memory = (acpi_srat_memory_t*)acpi_srat_header;
+            uint64_t base = ((uint64_t)memory->base[1] << 32) | memory->base[0];
+            uint64_t length = ((uint64_t)memory->length[1] << 32) | memory->length[0];
+            domain = memory->domain;
+            if (!(memory->flags & SRAT_FLAG_ENABLED) || length == 0) {
+                break;
+            }
+            if (domain >= CONFIG_MAX_NUM_NUMA_NODES) {
+                printf("ACPI: Ignoring SRAT_MEMORY in domain %d, only support %d\n",
+                       domain, CONFIG_MAX_NUM_NUMA_NODES);
+                break;
+            }
+            if (base + length != (uint64_t)(paddr_t)(base + length)) {
+                printf("ACPI: Ignoring SRAT_MEMORY that is not addressable\n");
+                break;
+            }
+            printf("ACPI: SRAT_MEMORY base=0x%llx length=0x%llx domain=%d\n",
+                   (long long)base, (long long)length, domain);
+            if (numa_info->num_mem_regions == MAX_NUM_NUMA_MEM_REGIONS) {
+                printf("ACPI: Not recording this memory affinity, only support %d\n", MAX_NUM_NUMA_MEM_REGIONS);
+                break;
+            }
+            numa_info->mem_regions[numa_info->num_mem_regions] = (acpi_numa_mem_region_t) {
+                .start = base, .end = base + length, .node = domain
+            };
+            numa_info->num_mem_regions++;
+            numa_info->num_nodes = MAX(numa_info->num_nodes, domain + 1);
+            break;
+        }
+        default:
+            break;
+        }
+        acpi_srat_header = (acpi_srat_header_t*)((char*)acpi_srat_header + acpi_srat_header->length);
+    }
+}
+
+BOOT_CODE static void
+acpi_slit_parse(acpi_slit_t* acpi_slit_mapped, acpi_numa_info_t* numa_info)
+{
+    uint32_t localities = acpi_slit_mapped->num_localities[0];
+    uint32_t i, j;
+
+    if (acpi_slit_mapped->num_localities[1] != 0 ||
+            sizeof(acpi_slit_t) + (uint64_t)localities * localities > acpi_slit_mapped->header.length) {
+        printf("ACPI: SLIT corrupt, ignoring it\n");
+        return;
+    }
+    for (i = 0; i < localities && i < CONFIG_MAX_NUM_NUMA_NODES; i++) {
+        for (j = 0; j < localities && j < CONFIG_MAX_NUM_NUMA_NODES; j++) {
+            numa_info->distance[i][j] = acpi_slit_mapped->entry[i * localities + j];
+        }
+    }
+}
+
+BOOT_CODE void
+acpi_numa_scan(
+    acpi_rsdp_t*      acpi_rsdp,
+    cpu_id_t*         cpu_list,
+    uint32_t          num_cpu,
+    acpi_numa_info_t* numa_info
+)
+{
+    unsigned int entries;
+    uint32_t count;
+    uint32_t i, j;
+    acpi_header_t* acpi_table;
+
+    acpi_rsdt_t* acpi_rsdt_mapped;
+    acpi_header_t* acpi_table_mapped;
+    acpi_rsdt_mapped = (acpi_rsdt_t*)acpi_table_init((acpi_rsdt_t*)(word_t)acpi_rsdp->rsdt_address, ACPI_RSDT);
+
+    numa_info->num_nodes = 0;
+    numa_info->num_mem_regions = 0;
+    for (i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+        numa_info->cpu_node[i] = NUMA_NODE_INVALID;
+    }
+    /* without a SLIT all remote nodes are considered to be equally distant */
+    for (i = 0; i < CONFIG_MAX_NUM_NUMA_NODES; i++) {
+        for (j = 0; j < CONFIG_MAX_NUM_NUMA_NODES; j++) {
+            numa_info->distance[i][j] = (i == j) ? 10 : 20;
+        }
+    }
+
+    assert(acpi_rsdt_mapped->header.length >= sizeof(acpi_header_t));
+    /* Divide by uint32_t explicitly as this is the size as mandated by the ACPI standard */
+    entries = (acpi_rsdt_mapped->header.length - sizeof(acpi_header_t)) / sizeof(uint32_t);
+    for (count = 0; count < entries; count++) {
+        acpi_table = (acpi_header_t*)(word_t)acpi_rsdt_mapped->entry[count];
+        acpi_table_mapped = (acpi_header_t*)acpi_table_init(acpi_table, ACPI_RSDT);
+
+        if (strncmp(acpi_str_srat, acpi_table_mapped->signature, 4) == 0) {
+            printf("ACPI: SRAT paddr=%p\n", acpi_table);
+            printf("ACPI: SRAT vaddr=%p\n", acpi_table_mapped);
+            acpi_srat_parse((acpi_srat_t*)acpi_table_mapped, cpu_list, num_cpu, numa_info);
+        } else if (strncmp(acpi_str_slit, acpi_table_mapped->signature, 4) == 0) {
+            printf("ACPI: SLIT paddr=%p\n", acpi_table);
+            printf("ACPI: SLIT vaddr=%p\n", acpi_table_mapped);
+            acpi_slit_parse((acpi_slit_t*)acpi_table_mapped, numa_info);
+        }
+    }
+
+    printf("ACPI: %d NUMA node(s) detected\n", numa_info->num_nodes);
+}
+#endif /* CONFIG_NUMA */